@@ -18,13 +18,15 @@ void ednadac::create(account_name issuer,
 
     stats statstable(_self, sym.name());
     auto existing = statstable.find(sym.name());
+    METER(MT_STAT, reads);
     eosio_assert(existing == statstable.end(), "stake with symbol already exists");
 
-    statstable.emplace(_self, [&](auto &s) {
+    auto st_itr = statstable.emplace(_self, [&](auto &s) {
         s.supply.symbol = maximum_supply.symbol;
         s.max_supply = maximum_supply;
         s.issuer = issuer;
     });
+    METER_ROW(MT_STAT, emplaces, *st_itr);
 }
 
 void ednadac::issue(account_name to, asset quantity, string memo)
@@ -36,6 +38,7 @@ void ednadac::issue(account_name to, asset quantity, string memo)
     auto sym_name = sym.name();
     stats statstable(_self, sym_name);
     auto existing = statstable.find(sym_name);
+    METER(MT_STAT, reads);
     eosio_assert(existing != statstable.end(), "stake with symbol does not exist, create stake before issue");
     const auto &st = *existing;
 
@@ -49,6 +52,7 @@ void ednadac::issue(account_name to, asset quantity, string memo)
     statstable.modify(st, 0, [&](auto &s) {
         s.supply += quantity;
     });
+    METER_ROW(MT_STAT, writes, st);
 
     add_balance(st.issuer, quantity, st.issuer);
 
@@ -69,6 +73,7 @@ void ednadac::transfer(account_name from,
     auto sym = quantity.symbol.name();
     stats statstable(_self, sym);
     const auto &st = statstable.get(sym);
+    METER(MT_STAT, reads);
 
     require_recipient(from);
     require_recipient(to);
@@ -82,35 +87,288 @@ void ednadac::transfer(account_name from,
     add_balance(to, quantity, from);
 }
 
+/*
+*   Pays several recipients from one account - stat is read and the sender debited once for the whole batch
+*/
+void ednadac::transfermany(account_name from, vector<payout> payouts, string memo, bool notify)
+{
+    require_auth(from);
+    eosio_assert(payouts.size() > 0 && payouts.size() <= MAX_BATCH_ROWS, "invalid number of payouts");
+    eosio_assert(memo.size() <= 256, "memo has more than 256 bytes");
+
+    auto sym = payouts[0].quantity.symbol.name();
+    stats statstable(_self, sym);
+    const auto &st = statstable.get(sym);
+    METER(MT_STAT, reads);
+
+    asset total = asset{static_cast<int64_t>(0), st.supply.symbol};
+    for (const auto &p : payouts)
+    {
+        eosio_assert(p.to != from, "cannot transfer to self");
+        eosio_assert(is_account(p.to), "to account does not exist");
+        eosio_assert(p.quantity.is_valid(), "invalid quantity");
+        eosio_assert(p.quantity.amount > 0, "must transfer positive quantity");
+        eosio_assert(p.quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+        total += p.quantity;
+    }
+
+    sub_balance(from, total);
+    if (notify)
+    {
+        require_recipient(from);
+    }
+
+    for (const auto &p : payouts)
+    {
+        add_balance(p.to, p.quantity, from);
+        if (notify)
+        {
+            require_recipient(p.to);
+        }
+    }
+}
+
 void ednadac::setmemfund(account_name _memfund)
 {
     require_auth(_self);
-    config_table c_t(_self, _self);
-    auto c_itr = c_t.find(0);
-    if (c_itr == c_t.end())
+    eosio_assert(is_account(_memfund), "membership fund account does not exist");
+
+    if (!_config_single.exists())
     {
-        c_t.emplace(_self, [&](auto &c) {
-            c.mem_fund = _memfund;
-        });
+        _config = config{};                                                     // first write starts from the defaults
+        _config.config_id = 0;
+        _config.mem_fund = _memfund;
+        update_thresholds(_config);
+        _config_loaded = true;
+        _config_dirty = true;
     }
     else
     {
-        c_t.modify(c_itr, _self, [&](auto &c) {
-            c.mem_fund = _memfund;
-        });
+        edit_config().mem_fund = _memfund;
     }
+
+    retime_job(JOB_MEM_CHECK, 0, now() + MEM_CHECK_INTERVAL);                  // queues the sweep if neither writer has yet
+}
+
+void ednadac::setconfig(config _new)
+{
+    require_auth(_self);
+
+    eosio_assert(_new.mem_ttl > 0, "membership duration must be positive");
+    eosio_assert(_new.proposal_escalation > 0 && _new.proposal_escalation <= 100, "proposal escalation must be between 1 and 100 %");
+    eosio_assert(_new.referendum_passage > 0 && _new.referendum_passage <= 100, "referendum passage must be between 1 and 100 %");
+    eosio_assert(_new.mem_vote_ttl > 0 && _new.custodian_vote_ttl > 0, "voting windows must be positive");
+    eosio_assert(_new.nominations_ttl > 0 && _new.elections_ttl > 0 && _new.custodian_ttl > 0, "election windows must be positive");
+    eosio_assert(_new.news_ttl > 0, "news lifetime must be positive");
+    eosio_assert(_new.news_capacity > 0 && _new.news_capacity <= MAX_NEWS_CAPACITY, "invalid news capacity");
+    eosio_assert(_new.custodian_count > 0, "there must be at least one custodian");
+    eosio_assert(_new.committee_size > 0, "research committees need at least one seat");
+    eosio_assert(_new.custodial_majority > 0 && _new.custodial_majority <= _new.custodian_count, "custodial majority must be between 1 and the custodian count");
+    eosio_assert(_new.ref_shards > 0 && _new.ref_shards <= MAX_REF_SHARDS, "invalid number of referendum shards");
+    eosio_assert(_new.mem_fee.is_valid() && _new.mem_fee.amount > 0, "membership fee must be a positive asset");
+    eosio_assert(is_account(_new.mem_fund), "membership fund account does not exist");
+
+    // running state is owned by the contract, only the settings are taken from the caller
+    config current = _config_single.exists() ? get_config() : config{};
+    _new.config_id = 0;
+    _new.member_count = current.member_count;
+    _new.next_member_id = current.next_member_id;
+    _new.next_election_due = current.next_election_due;
+    _new.last_election_id = current.last_election_id;
+    _new.custodians_seated = current.custodians_seated;
+    _new.news_next = current.news_next;
+    _new.dac_funds_main = current.dac_funds_main;
+    _new.dac_funds_approved_spend = current.dac_funds_approved_spend;
+    _new.dac_funds_rewards = current.dac_funds_rewards;
+    _new.reward_per_member = current.reward_per_member;
+    update_thresholds(_new);
+
+    _config = _new;
+    _config_loaded = true;
+    _config_dirty = true;
+
+    retime_job(JOB_MEM_CHECK, 0, now() + MEM_CHECK_INTERVAL);                  // queues the sweep if neither writer has yet
 }
 
+/*
+*   Reads the config singleton at most once per action
+*/
+const ednadac::config &ednadac::get_config()
+{
+    if (!_config_loaded)
+    {
+        eosio_assert(_config_single.exists(), "DAC is not configured.");
+        _config = _config_single.get();
+        _config_loaded = true;
+    }
+    return _config;
+}
+
+/*
+*   Same as get_config but the cached copy is written back when the action finishes
+*/
+ednadac::config &ednadac::edit_config()
+{
+    get_config();
+    _config_dirty = true;
+    return _config;
+}
+
+ednadac::~ednadac()
+{
+    if (_config_dirty)
+    {
+        _config_single.set(_config, _self);
+    }
+#ifdef EDNADAC_METRICS
+    dump_meters();
+#endif
+}
+
+#ifdef EDNADAC_METRICS
+/*
+*   Prints the table accounting for this action as one JSON object - it lands in the action's console
+*   output on a node (contracts-console), or on stdout in a host build
+*/
+void ednadac::dump_meters() const
+{
+    static const char *names[MT_COUNT] = { "members", "proposals", "votes", "accounts", "stat", "newss" };
+
+    print("{\"tables\":{");
+    for (int t = 0; t < MT_COUNT; t++)
+    {
+        const auto &m = _meters[t];
+        print(t ? "," : "", "\"", names[t], "\":{\"reads\":", m.reads, ",\"writes\":", m.writes,
+              ",\"emplaces\":", m.emplaces, ",\"erases\":", m.erases, ",\"bytes\":", m.bytes, "}");
+    }
+    print("}}\n");
+}
+#endif
+
+/*
+*   Converts the escalation and referendum percentages into absolute vote counts
+*   Must be called whenever member_count, proposal_escalation or referendum_passage changes
+*/
+void ednadac::update_thresholds(config &c)
+{
+    eosio_assert(c.proposal_escalation <= 100 && c.referendum_passage <= 100, "percentage may not exceed 100.");
+
+    // round up so the threshold is never below the configured %, and always require at least one vote
+    uint64_t escalation = (uint64_t)(((uint128_t)c.member_count * c.proposal_escalation + 99) / 100);
+    uint64_t referendum = (uint64_t)(((uint128_t)c.member_count * c.referendum_passage + 99) / 100);
+    c.escalation_votes = (escalation > 0) ? escalation : 1;
+    c.referendum_votes = (referendum > 0) ? referendum : 1;
+}
 
 /*******************************************************************************
  * Global Management *******************************************************
  *******************************************************************************/
-//void ednadac::globalalarms(){
-//    ednadac::general_proposal_check();
-//    ednadac::memberhip_check();
-//    ednadac::custodian_check();
 
-//};
+// runs every job that is due (at most MAX_SWEEP_ROWS of them) then re-arms itself for the next one
+void ednadac::globalalarms(){
+  require_auth(_self);
+
+  job_table j_t(_self, _self);
+  auto j_idx = j_t.get_index<N(due)>();
+  uint32_t processed = 0;
+
+  auto itr = j_idx.begin();
+  while (itr != j_idx.end() && itr->due_time <= now() && processed < MAX_SWEEP_ROWS)
+  {
+    uint64_t next_due = 0;
+    run_job(*itr, next_due);
+    if (next_due == 0){                                                         // nothing left to do for this target
+      j_idx.erase(itr);
+    }
+    else {
+      j_idx.modify(itr, 0, [&](auto &j) {
+        j.due_time = next_due;
+      });
+    }
+    processed++;
+    itr = j_idx.begin();
+  }
+
+  prune_news(MAX_SWEEP_ROWS);
+  arm_alarm();
+}
+
+// queues a job and makes sure the alarm fires no later than its due time
+void ednadac::schedule_job(uint8_t job_type, uint64_t target_id, uint64_t due_time){
+  job_table j_t(_self, _self);
+  j_t.emplace(_self, [&](auto &j) {
+    j.job_id = j_t.available_primary_key();
+    j.due_time = due_time;
+    j.job_type = job_type;
+    j.target_id = target_id;
+  });
+
+  arm_alarm();
+}
+
+// brings a queued job forward when its target's deadline moved earlier - later deadlines are picked up by run_job
+void ednadac::retime_job(uint8_t job_type, uint64_t target_id, uint64_t due_time){
+  job_table j_t(_self, _self);
+  auto j_idx = j_t.get_index<N(bytarget)>();
+  auto itr = j_idx.find(((uint128_t)job_type << 64) | target_id);
+  if (itr == j_idx.end()){
+    schedule_job(job_type, target_id, due_time);
+    return;
+  }
+  if (itr->due_time <= due_time){
+    return;
+  }
+
+  j_idx.modify(itr, 0, [&](auto &j) {
+    j.due_time = due_time;
+  });
+  arm_alarm();
+}
+
+// sets next_due to the time the target needs looking at again, or leaves it 0 when the job is finished
+void ednadac::run_job(const job &j, uint64_t &next_due){
+  if (j.job_type == JOB_PROP_CHECK){
+    proposal_table p_t(_self, _self);
+    auto p_itr = p_t.find(j.target_id);
+    METER(MT_PROPOSALS, reads);
+    if (p_itr == p_t.end()){
+      return;
+    }
+    if (p_itr->prop_next_action_date <= now()){
+      p_t.modify(p_itr, 0, [&](auto &p) {
+        advance_proposal(p, get_config());
+      });
+      METER_ROW(MT_PROPOSALS, writes, *p_itr);
+    }
+    if (p_itr->prop_next_action_date != PROP_NO_ACTION){                        // deadline may also have moved later from a vote - earlier moves call retime_job
+      next_due = p_itr->prop_next_action_date;
+    }
+  }
+  else if (j.job_type == JOB_ELECTION_CHECK){
+    next_due = advance_election(j.target_id);
+  }
+  else if (j.job_type == JOB_MEM_CHECK){                                        // recurring - runs again tomorrow, or at once if the batch was full
+    uint32_t processed = sweep_members(MAX_SWEEP_ROWS);
+    next_due = now() + ((processed == MAX_SWEEP_ROWS) ? 1 : MEM_CHECK_INTERVAL);
+  }
+}
+
+// replaces the pending alarm with one timed to the earliest queued job - an empty queue leaves no alarm
+void ednadac::arm_alarm(){
+  job_table j_t(_self, _self);
+  auto j_idx = j_t.get_index<N(due)>();
+  auto itr = j_idx.begin();
+
+  cancel_deferred(N(globalalarms));
+  if (itr == j_idx.end()){
+    return;
+  }
+
+  eosio::transaction out;
+  out.actions.emplace_back(permission_level{_self, N(active)}, _self, N(globalalarms), std::make_tuple());
+  out.delay_sec = (itr->due_time > now()) ? (itr->due_time - now()) : 0;
+  out.send(N(globalalarms), _self);
+}
 
 
 
@@ -120,20 +378,25 @@ void ednadac::setmemfund(account_name _memfund)
 
 void ednadac::addmember(account_name _account, string tele_user, asset dues){
   require_auth(_account);
-  config_table c_t (_self, _self);
-  auto c_itr = c_t.find(0);
-  account_name _mem_fund = c_itr->mem_fund;
+  const auto &cfg = get_config();
+  account_name _mem_fund = cfg.mem_fund;
 
   eosio_assert(tele_user != "", "telegram username may not be blank.");
-  eosio_assert(c_itr->new_members_allowed != 0,"new membership is currently disabled.");
+  eosio_assert(cfg.new_members_allowed != 0,"new membership is currently disabled.");
 
   member_table m_t(_self, _self);
-  auto itr = m_t.find(_account);
-  eosio_assert(itr == m_t.end(), "Account already is a DAC member.");
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(itr == m_idx.end(), "Account already is a DAC member.");
+  memarchive_table ma_t(_self, _self);
+  auto ma_idx = ma_t.get_index<N(byaccount)>();
+  eosio_assert(ma_idx.find(_account) == ma_idx.end(), "Account has left the DAC and may not rejoin.");
 
   auto sym = dues.symbol.name();
   stats statstable(_self, sym);
   const auto &st = statstable.get(sym);
+  METER(MT_STAT, reads);
 
   eosio_assert(dues.is_valid(), "invalid ");
   eosio_assert(dues.amount > 0, "must transfer positive ");
@@ -142,43 +405,113 @@ void ednadac::addmember(account_name _account, string tele_user, asset dues){
   sub_balance(_account, dues);
   add_balance(_mem_fund, dues, _account);
 
-  m_t.emplace(_self, [&](auto &c) {
-    c.member_id = m_t.available_primary_key();
+  auto &cfg_w = edit_config();
+  cfg_w.member_count += 1;
+  update_thresholds(cfg_w);
+
+  emplace_member(m_t, _account, tele_user, cfg.mem_ttl);
+}
+
+/*
+*   Batch form of addmember for enrollment waves - config, symbol and the fund balance are each touched once
+*/
+void ednadac::addmembers(vector<newmember> _members){
+  eosio_assert(_members.size() > 0 && _members.size() <= MAX_BATCH_ROWS, "invalid number of members in batch.");
+
+  const auto &cfg = get_config();
+  eosio_assert(cfg.new_members_allowed != 0,"new membership is currently disabled.");
+
+  auto sym = cfg.mem_fee.symbol.name();
+  stats statstable(_self, sym);
+  const auto &st = statstable.get(sym);
+  METER(MT_STAT, reads);
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  memarchive_table ma_t(_self, _self);
+  auto ma_idx = ma_t.get_index<N(byaccount)>();
+  asset total_dues = asset{static_cast<int64_t>(0), st.supply.symbol};
+
+  for (const auto &nm : _members)
+  {
+    require_auth(nm.account);
+    eosio_assert(nm.tele_user != "", "telegram username may not be blank.");
+    eosio_assert(m_idx.find(nm.account) == m_idx.end(), "Account already is a DAC member.");
+    METER(MT_MEMBERS, reads);
+    eosio_assert(ma_idx.find(nm.account) == ma_idx.end(), "Account has left the DAC and may not rejoin.");
+    eosio_assert(nm.dues.is_valid(), "invalid ");
+    eosio_assert(nm.dues.amount > 0, "must transfer positive ");
+    eosio_assert(nm.dues.symbol == st.supply.symbol, "symbol precision mismatch");
+
+    sub_balance(nm.account, nm.dues);
+    total_dues += nm.dues;
+    emplace_member(m_t, nm.account, nm.tele_user, cfg.mem_ttl);
+  }
+
+  add_balance(cfg.mem_fund, total_dues, _self);
+
+  auto &cfg_w = edit_config();
+  cfg_w.member_count += _members.size();
+  update_thresholds(cfg_w);
+}
+
+// writes the hot and cold rows for a new member
+void ednadac::emplace_member(member_table &m_t, account_name _account, const string &tele_user, uint32_t mem_ttl){
+  // archiving erases the members row, so the table's next key could hand a new member the id of an archived
+  // one and its memarchives record. available_primary_key covers tables from before the counter
+  auto &cfg = edit_config();
+  uint64_t member_id = (cfg.next_member_id > m_t.available_primary_key()) ? cfg.next_member_id : m_t.available_primary_key();
+  cfg.next_member_id = member_id + 1;
+  auto new_itr = m_t.emplace(_self, [&](auto &c) {
+    c.member_id = member_id;
     c.account = _account;
     c.member_status = MEM_MEMBER;
+    c.lapsed_from = MEM_MEMBER;
     c.custodial_status = CUSTO_NONE;
-    c.telegram_user = tele_user;
     c.proposal_count = 0;
     c.vote_count = 0;
     c.completed_service_count = 0;
+    c.research_opt_in_count = 0;
     c.completed_service_value = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};
     c.research_value_earned = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};
     c.total_value_earned = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};
-    c.member_balance = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};;
-    c.ipfs_member_bio = "";
-    c.ipfs_member_photo = "";
-    c.ipfs_member_video = "";
-    c.ipfs_traits_data = "";
-    c.ipfs_gen_data = "";
+    c.member_balance = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};
+    c.reward_checkpoint = get_config().reward_per_member;                      // only shares in rewards from now on
     c.joined_date = now();
-    c.renewal_date = now() + c_itr->mem_ttl;
+    c.renewal_date = now() + mem_ttl;
+  });
+  METER_ROW(MT_MEMBERS, emplaces, *new_itr);
+
+  memprofile_table mp_t(_self, _self);
+  mp_t.emplace(_self, [&](auto &c) {
+    c.member_id = member_id;
+    c.telegram_user = tele_user;
+    c.ipfs_member_bio = ipfshash{};
+    c.ipfs_member_photo = ipfshash{};
+    c.ipfs_member_video = ipfshash{};
+    c.ipfs_traits_data = ipfshash{};
+    c.ipfs_gen_data = ipfshash{};
+    c.spare4 = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};
   });
 }
 
-void ednadac::renew_membership(account_name _account){
+void ednadac::renewmember(account_name _account){
+  require_auth(_account);
 
   member_table m_t(_self, _self);
-  auto itr = m_t.find(_account);
-  eosio_assert(itr != m_t.end(), "member account does not exist.");
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(itr != m_idx.end(), "member account does not exist.");
 
-  config_table c_t (_self, _self);
-  auto c_itr = c_t.find(0);
-  asset renewal_fee = c_itr->mem_fee;
-  account_name _mem_fund = c_itr->mem_fund;
+  const auto &cfg = get_config();
+  asset renewal_fee = cfg.mem_fee;
+  account_name _mem_fund = cfg.mem_fund;
 
   auto sym = renewal_fee.symbol.name();
   stats statstable(_self, sym);
   const auto &st = statstable.get(sym);
+  METER(MT_STAT, reads);
 
   eosio_assert(renewal_fee.is_valid(), "invalid ");
   eosio_assert(renewal_fee.amount > 0, "must transfer positive ");
@@ -187,9 +520,115 @@ void ednadac::renew_membership(account_name _account){
   sub_balance(_account, renewal_fee);
   add_balance(_mem_fund, renewal_fee, _account);
 
-    m_t.modify(itr, _self, [&](auto &c) {
-      c.renewal_date += c.renewal_date + c_itr->mem_ttl;
+    bool reinstated = false;
+    m_idx.modify(itr, _self, [&](auto &c) {
+      reinstated = extend_membership(c, cfg.mem_ttl);
     });
+    METER_ROW(MT_MEMBERS, writes, *itr);
+
+    if (reinstated){
+      auto &cfg_w = edit_config();
+      cfg_w.member_count += 1;
+      update_thresholds(cfg_w);
+    }
+}
+
+/*
+*   Batch form of renewmember - every account pays the current mem_fee, mem_fund is credited once
+*/
+void ednadac::renewmembers(vector<account_name> _accounts){
+  eosio_assert(_accounts.size() > 0 && _accounts.size() <= MAX_BATCH_ROWS, "invalid number of members in batch.");
+
+  const auto &cfg = get_config();
+  asset renewal_fee = cfg.mem_fee;
+
+  auto sym = renewal_fee.symbol.name();
+  stats statstable(_self, sym);
+  const auto &st = statstable.get(sym);
+  METER(MT_STAT, reads);
+
+  eosio_assert(renewal_fee.is_valid(), "invalid ");
+  eosio_assert(renewal_fee.amount > 0, "must transfer positive ");
+  eosio_assert(renewal_fee.symbol == st.supply.symbol, "symbol precision mismatch");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  uint32_t reinstated = 0;
+
+  for (const auto &acct : _accounts)
+  {
+    require_auth(acct);
+    auto itr = m_idx.find(acct);
+    METER(MT_MEMBERS, reads);
+    eosio_assert(itr != m_idx.end(), "member account does not exist.");
+
+    sub_balance(acct, renewal_fee);
+    m_idx.modify(itr, _self, [&](auto &c) {
+      reinstated += extend_membership(c, cfg.mem_ttl) ? 1 : 0;
+    });
+    METER_ROW(MT_MEMBERS, writes, *itr);
+  }
+
+  add_balance(cfg.mem_fund, renewal_fee * static_cast<int64_t>(_accounts.size()), _self);
+
+  if (reinstated > 0){
+    auto &cfg_w = edit_config();
+    cfg_w.member_count += reinstated;
+    update_thresholds(cfg_w);
+  }
+}
+
+// pushes the renewal date out by mem_ttl - a member lapsed by memcheck is reinstated and true is returned
+bool ednadac::extend_membership(member &c, uint32_t mem_ttl){
+  bool reinstated = (c.member_status == MEM_LAPSED);
+  if (reinstated){
+    c.member_status = c.lapsed_from;
+    c.reward_checkpoint = get_config().reward_per_member;                      // no share of rewards made while lapsed
+  }
+  else {
+    settle_rewards(c);
+  }
+  c.renewal_date = ((c.renewal_date > now()) ? c.renewal_date : now()) + mem_ttl;
+  return reinstated;
+}
+
+void ednadac::memcheck(uint32_t _max_rows){
+  eosio_assert(_max_rows > 0 && _max_rows <= MAX_SWEEP_ROWS, "invalid number of rows to sweep.");
+  sweep_members(_max_rows);
+}
+
+/*
+*   Lapses up to max_rows expired members, soonest expiry first within each active status, and takes
+*   them out of member_count so the vote thresholds only count current members
+*/
+uint32_t ednadac::sweep_members(uint32_t max_rows){
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byrenewal)>();
+  uint32_t processed = 0;
+
+  for (uint8_t status = MEM_MEMBER; status <= MEM_DNA_ON_CHAIN && processed < max_rows; status++)
+  {
+    auto itr = m_idx.lower_bound(member::status_renewal_key(status, 0));
+    while (itr != m_idx.end() && itr->member_status == status && itr->renewal_date < now() && processed < max_rows)
+    {
+      METER(MT_MEMBERS, reads);
+      m_idx.modify(itr, 0, [&](auto &c) {
+        settle_rewards(c);
+        c.lapsed_from = c.member_status;
+        c.member_status = MEM_LAPSED;
+      });
+      METER_ROW(MT_MEMBERS, writes, *itr);
+      processed++;
+      itr = m_idx.lower_bound(member::status_renewal_key(status, 0));
+    }
+  }
+
+  if (processed > 0){
+    auto &cfg = edit_config();
+    cfg.member_count -= (cfg.member_count > processed) ? processed : cfg.member_count;
+    update_thresholds(cfg);
+  }
+  return processed;
 }
 
  void ednadac::updatemember(
@@ -203,28 +642,58 @@ void ednadac::renew_membership(account_name _account){
 
   )
 {
+ check_update_auth(_account, _upd_type, _param_i8);
+
  member_table m_t(_self, _self);
- auto itr = m_t.find(_account);
- eosio_assert(itr != m_t.end(), "member account does not exist.");
+ auto m_idx = m_t.get_index<N(byaccount)>();
+ auto itr = m_idx.find(_account);
+ METER(MT_MEMBERS, reads);
+ eosio_assert(itr != m_idx.end(), "member account does not exist.");
  bool renewal_due = false;
  if(itr->renewal_date < now()){
    renewal_due = true;
  }
  eosio_assert(renewal_due == false, "membership expired, please renew.");
 
-   m_t.modify(itr, _self, [&](auto &c) {
+   bool profile_update = (_upd_type == TELE_USER || _upd_type == MEM_BIO || _upd_type == MEM_PHOTO
+                        || _upd_type == MEM_VIDEO || _upd_type == MEM_TRAITS || _upd_type == MEM_GEN_DATA);
+
+   if(profile_update){                                                        // only the cold profile row is reserialized
+     memprofile_table mp_t(_self, _self);
+     auto mp_itr = mp_t.find(itr->member_id);
+     eosio_assert(mp_itr != mp_t.end(), "member profile does not exist.");
+
+     mp_t.modify(mp_itr, _self, [&](auto &c) {
+        if(_upd_type == TELE_USER){
+          c.telegram_user = _param_s;
+        }
+        if(_upd_type == MEM_BIO){
+          c.ipfs_member_bio = ipfs_decode(_param_s);
+        }
+        if(_upd_type == MEM_PHOTO){
+          c.ipfs_member_photo = ipfs_decode(_param_s);
+        }
+        if(_upd_type == MEM_VIDEO){
+          c.ipfs_member_video = ipfs_decode(_param_s);
+        }
+        if(_upd_type == MEM_TRAITS){
+          c.ipfs_traits_data = ipfs_decode(_param_s);
+        }
+        if(_upd_type == MEM_GEN_DATA){
+          c.ipfs_gen_data = ipfs_decode(_param_s);
+        }
+      });
+     return;
+   }
+
+   m_idx.modify(itr, _self, [&](auto &c) {
+      settle_rewards(c);
       if(_upd_type == MEM_STATUS){
         c.member_status = _param_i8;
-        if (_param_i8 == MEM_BANNED || _param_i8 == MEM_QUIT){
-            ednadac::archivemember(_account);
-        }
       }
       if(_upd_type == CUST_STATUS){
         c.custodial_status = _param_i8;
       }
-      if(_upd_type == TELE_USER){
-        c.telegram_user = _param_i8;
-      }
       if(_upd_type == PROP_COUNT){
         c.proposal_count += 1;
       }
@@ -247,117 +716,826 @@ void ednadac::renew_membership(account_name _account){
       if(_upd_type == MEM_BALANCE && _param_s == "rem"){         //GGS - need money moving checks here
         c.member_balance -= _param_asset;
       }
-      if(_upd_type == MEM_BIO){
-        c.ipfs_member_bio = _param_s;
-      }
-      if(_upd_type == MEM_PHOTO){
-        c.ipfs_member_photo = _param_s;
-      }
-      if(_upd_type == MEM_VIDEO){
-        c.ipfs_member_video = _param_s;
-      }
-      if(_upd_type == MEM_TRAITS){
-        c.ipfs_traits_data = _param_s;
+    });
+   METER_ROW(MT_MEMBERS, writes, *itr);
+
+   if(_upd_type == MEM_STATUS && (_param_i8 == MEM_BANNED || _param_i8 == MEM_QUIT)){
+     queue_archive(_account, itr->member_id, 0);
+   }
+}
+
+/*
+*   Applies a list of updates to one member - the hot and cold rows are each modified at most once
+*/
+void ednadac::updmemfields(account_name _account, vector<memupdate> _updates){
+  eosio_assert(_updates.size() > 0 && _updates.size() <= MAX_BATCH_ROWS, "invalid number of updates.");
+
+  bool hot_update = false;
+  bool profile_update = false;
+  for (const auto &u : _updates)
+  {
+    check_update_auth(_account, u.field, u.param_i8);
+    switch (u.field)
+    {
+      case TELE_USER: case MEM_BIO: case MEM_PHOTO: case MEM_VIDEO: case MEM_TRAITS: case MEM_GEN_DATA:
+        profile_update = true;
+        break;
+      case MEM_STATUS: case CUST_STATUS: case PROP_COUNT: case VOTE_COUNT: case COMP_SERVICE: case COMP_RESEARCH: case MEM_BALANCE:
+        hot_update = true;
+        break;
+      default:                                                                  // rejected before either row is touched
+        eosio_assert(false, "invalid member update type.");
+    }
+  }
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(itr->renewal_date >= now(), "membership expired, please renew.");
+
+  if (profile_update){
+    memprofile_table mp_t(_self, _self);
+    auto mp_itr = mp_t.find(itr->member_id);
+    eosio_assert(mp_itr != mp_t.end(), "member profile does not exist.");
+
+    mp_t.modify(mp_itr, _self, [&](auto &c) {
+      for (const auto &u : _updates)
+      {
+        switch (u.field)
+        {
+          case TELE_USER:     c.telegram_user = u.param_s;                        break;
+          case MEM_BIO:       c.ipfs_member_bio = ipfs_decode(u.param_s);         break;
+          case MEM_PHOTO:     c.ipfs_member_photo = ipfs_decode(u.param_s);       break;
+          case MEM_VIDEO:     c.ipfs_member_video = ipfs_decode(u.param_s);       break;
+          case MEM_TRAITS:    c.ipfs_traits_data = ipfs_decode(u.param_s);        break;
+          case MEM_GEN_DATA:  c.ipfs_gen_data = ipfs_decode(u.param_s);           break;
+        }
       }
-      if(_upd_type == MEM_GEN_DATA){
-        require_auth(_self);
-        c.ipfs_traits_data = _param_s;
+    });
+  }
+
+  bool archive = false;
+  if (hot_update){
+    m_idx.modify(itr, _self, [&](auto &c) {
+      settle_rewards(c);
+      for (const auto &u : _updates)
+      {
+        switch (u.field)
+        {
+          case MEM_STATUS:
+            c.member_status = u.param_i8;
+            archive = (u.param_i8 == MEM_BANNED || u.param_i8 == MEM_QUIT);
+            break;
+          case CUST_STATUS:
+            c.custodial_status = u.param_i8;
+            break;
+          case PROP_COUNT:
+            c.proposal_count += 1;
+            break;
+          case VOTE_COUNT:
+            c.vote_count += 1;
+            break;
+          case COMP_SERVICE:
+            c.completed_service_count += 1;
+            c.completed_service_value += u.param_asset;
+            c.total_value_earned += u.param_asset;
+            break;
+          case COMP_RESEARCH:
+            c.completed_service_count += 1;
+            c.research_value_earned += u.param_asset;
+            c.total_value_earned += u.param_asset;
+            break;
+          case MEM_BALANCE:
+            if (u.param_s == "add"){
+              c.member_balance += u.param_asset;
+            }
+            else if (u.param_s == "rem"){
+              c.member_balance -= u.param_asset;
+            }
+            break;
+          default:                                                              // profile fields - written above
+            break;
+        }
       }
     });
+    METER_ROW(MT_MEMBERS, writes, *itr);
+  }
+
+  if (archive){
+    queue_archive(_account, itr->member_id, 0);
+  }
+}
+
+/*
+*   Per-field authorization for member updates - see website_functions.txt
+*   Members may edit their own profile, quit, and move through the allowed custodial statuses,
+*   everything else is only written by the contract
+*/
+void ednadac::check_update_auth(account_name _account, uint8_t _upd_type, uint8_t _param_i8){
+  if (has_auth(_self)){
+    return;
+  }
+  require_auth(_account);
+
+  bool member_allowed = false;
+  switch (_upd_type)
+  {
+    case MEM_STATUS:
+      member_allowed = (_param_i8 == MEM_QUIT);
+      break;
+    case CUST_STATUS:
+      member_allowed = (_param_i8 == CUSTO_NOMINATED || _param_i8 == CUSTO_DECLINED
+                        || _param_i8 == CUSTO_RUNNING || _param_i8 == CUSTO_RETIRED);
+      break;
+    case TELE_USER: case MEM_BIO: case MEM_PHOTO: case MEM_VIDEO: case MEM_TRAITS:
+      member_allowed = true;
+      break;
+  }
+  eosio_assert(member_allowed, "this update is not permitted for members.");
+}
+
+/*
+*   Releases the RAM held by a departed member - runs in bounded batches and re-queues itself
+*   until every vote, news, opt-in, committee seat and candidacy row is gone, then leaves a small memarchives
+*   record behind - the opt-in and committee counts drop as their rows go, and the account may not rejoin
+*/
+void ednadac::archivemem(account_name _account){
+  require_auth(_self);
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(itr->member_status == MEM_BANNED || itr->member_status == MEM_QUIT, "member is still active.");
+  uint64_t member_id = itr->member_id;
+  uint32_t erased = 0;
+
+  vote_table v_t(_self, _self);
+  auto v_idx = v_t.get_index<N(bymember)>();
+  auto v_itr = v_idx.lower_bound(member_id);
+  while (v_itr != v_idx.end() && v_itr->member_id == member_id && erased < MAX_SWEEP_ROWS)
+  {
+    v_itr = v_idx.erase(v_itr);                                                 // tallies already hold these votes
+    METER(MT_VOTES, erases);
+    erased++;
+  }
+
+  news_table n_t(_self, _self);
+  auto n_idx = n_t.get_index<N(bymember)>();
+  auto n_itr = n_idx.lower_bound(member_id);
+  while (n_itr != n_idx.end() && n_itr->member_id == member_id && erased < MAX_SWEEP_ROWS)
+  {
+    n_itr = n_idx.erase(n_itr);
+    METER(MT_NEWSS, erases);
+    erased++;
+  }
+
+  research_table r_t(_self, _self);
+  resmemxref_table rx_t(_self, _self);
+  auto rx_idx = rx_t.get_index<N(bymember)>();
+  auto rx_itr = rx_idx.lower_bound((uint128_t)member_id << 64);
+  while (rx_itr != rx_idx.end() && rx_itr->member_id == member_id && erased < MAX_SWEEP_ROWS)
+  {
+    auto r_itr = r_t.find(rx_itr->research_id);
+    if (r_itr != r_t.end()){                                                    // a share not yet fixed by distribute goes to those left
+      r_t.modify(r_itr, 0, [&](auto &r) {
+        r.number_of_opt_ins -= 1;
+      });
+    }
+    rx_itr = rx_idx.erase(rx_itr);
+    erased++;
+  }
+
+  rcommittee_table rc_t(_self, _self);
+  rcommember_table rm_t(_self, _self);
+  auto rm_idx = rm_t.get_index<N(bymember)>();
+  auto rm_itr = rm_idx.lower_bound((uint128_t)member_id << 64);
+  while (rm_itr != rm_idx.end() && rm_itr->member_id == member_id && erased < MAX_SWEEP_ROWS)
+  {
+    auto rc_itr = rc_t.find(rm_itr->committee_id);
+    if (rc_itr != rc_t.end()){
+      rc_t.modify(rc_itr, 0, [&](auto &c) {
+        c.member_count -= 1;
+        if (c.chairman_id == member_id){
+          c.chairman_id = NO_MEMBER;
+        }
+      });
+    }
+    rm_itr = rm_idx.erase(rm_itr);
+    erased++;
+  }
+
+  elemembxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(bymember)>();
+  auto x_itr = x_idx.lower_bound((uint128_t)member_id << 64);
+  while (x_itr != x_idx.end() && x_itr->member_id == member_id && erased < MAX_SWEEP_ROWS)
+  {
+    if (x_itr->elected != 0 && x_itr->election_id == get_config().last_election_id){   // nothing left to unseat at the next election
+      auto &cfg = edit_config();
+      cfg.custodians_seated -= (cfg.custodians_seated > 0) ? 1 : 0;
+    }
+    x_itr = x_idx.erase(x_itr);                                                 // ballots for the candidate no longer count
+    erased++;
+  }
+
+  if (erased == MAX_SWEEP_ROWS){                                                // batch full - there may be more
+    queue_archive(_account, member_id, 1);
+    return;
+  }
+
+  m_idx.modify(itr, 0, [&](auto &c) {
+    settle_rewards(c);
+  });
+  METER_ROW(MT_MEMBERS, writes, *itr);
+
+  memarchive_table ma_t(_self, _self);
+  ma_t.emplace(_self, [&](auto &a) {
+    a.member_id = member_id;
+    a.account = _account;
+    a.member_status = itr->member_status;
+    a.joined_date = itr->joined_date;
+    a.archived_date = now();
+    a.total_value_earned = itr->total_value_earned;
+    a.member_balance = itr->member_balance;
+  });
+
+  memprofile_table mp_t(_self, _self);
+  auto mp_itr = mp_t.find(member_id);
+  if (mp_itr != mp_t.end()){
+    mp_t.erase(mp_itr);
+  }
+
+  m_idx.erase(itr);
+  METER(MT_MEMBERS, erases);
+
+  auto &cfg = edit_config();
+  cfg.member_count -= (cfg.member_count > 0) ? 1 : 0;
+  update_thresholds(cfg);
+}
+
+// sends archivemem as a deferred transaction - one pending archive per member
+void ednadac::queue_archive(account_name _account, uint64_t member_id, uint32_t delay){
+  uint128_t sender_id = ((uint128_t)N(archivemem) << 64) | member_id;
+
+  eosio::transaction out;
+  out.actions.emplace_back(permission_level{_self, N(active)}, _self, N(archivemem), std::make_tuple(_account));
+  out.delay_sec = delay;
+  cancel_deferred(sender_id);
+  out.send(sender_id, _self);
 }
 
-void ednadac::archivemember(account_name _account){
-  // archive members records...propsals, voting,
+/*
+*   Decodes a base58 CIDv0 (Qm...) into its 34 byte sha2-256 multihash - an empty string clears the hash,
+*   which then costs a single length byte in the row
+*/
+ipfshash ednadac::ipfs_decode(const string &cid){
+  static const string alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+  ipfshash h;
+  if (cid.empty()){
+    return h;
+  }
+  eosio_assert(cid.size() == 46, "invalid IPFS hash length.");
+
+  vector<uint8_t> bytes(34, 0);
+  for (char ch : cid)
+  {
+    auto digit = alphabet.find(ch);
+    eosio_assert(digit != string::npos, "invalid character in IPFS hash.");
+
+    uint32_t carry = digit;                                                     // bytes = bytes * 58 + digit, big-endian
+    for (int i = 33; i >= 0; i--)
+    {
+      carry += 58 * (uint32_t)bytes[i];
+      bytes[i] = carry & 0xff;
+      carry >>= 8;
+    }
+    eosio_assert(carry == 0, "invalid IPFS hash.");
+  }
+  eosio_assert(bytes[0] == 0x12 && bytes[1] == 0x20, "only sha2-256 IPFS hashes are supported.");
 
-  // give back ram for voting table rease all rows for above
+  h.multihash = std::move(bytes);
+  return h;
+}
 
+/*******************************************************************************
+ * Member Rewards **************************************************************
+ *******************************************************************************/
 
+/*
+*   Moves _quantity of EDNA from _from into the contract's own balance and adds it to dac_funds_main,
+*   the pool rewardall shares out
+*/
+void ednadac::fundrewards(account_name _from, asset _quantity){
+  require_auth(_from);
 
+  auto &cfg = edit_config();
+  eosio_assert(_quantity.is_valid() && _quantity.amount > 0, "must fund a positive quantity");
+  eosio_assert(_quantity.symbol == cfg.dac_funds_main.symbol, "symbol precision mismatch");
 
+  sub_balance(_from, _quantity);
+  add_balance(_self, _quantity, _from);
+  cfg.dac_funds_main += _quantity;
 }
+
+/*
+*   Shares _quantity of dac_funds_main equally between the current members - a single write to config,
+*   each member's share is paid out by settle_rewards the next time their row is touched
+*   The shares move to dac_funds_rewards until they are paid, so no other payout can spend them, and the
+*   rounding left over when _quantity does not divide by member_count stays in dac_funds_main
+*/
+void ednadac::rewardall(asset _quantity){
+  require_auth(_self);
+
+  auto &cfg = edit_config();
+  eosio_assert(cfg.member_count > 0, "there are no members to reward.");
+  eosio_assert(_quantity.is_valid() && _quantity.amount > 0, "must reward a positive quantity");
+  eosio_assert(_quantity.symbol == cfg.dac_funds_main.symbol, "symbol precision mismatch");
+  eosio_assert(_quantity.amount <= cfg.dac_funds_main.amount, "reward exceeds the DAC funds");
+
+  uint128_t per_member = ((uint128_t)_quantity.amount * REWARD_SCALE) / cfg.member_count;
+  eosio_assert(per_member > 0, "reward is too small to share between the members.");
+
+  uint128_t shared = per_member * cfg.member_count;                             // rounded up below, never less than the shares paid out
+  asset committed = asset{static_cast<int64_t>((shared + REWARD_SCALE - 1) / REWARD_SCALE), _quantity.symbol};
+
+  cfg.dac_funds_main -= committed;
+  cfg.dac_funds_rewards += committed;
+  cfg.reward_per_member += per_member;
+}
+
+// settles a member's rewards without any other change to their record
+void ednadac::claim(account_name _account){
+  require_auth(_account);
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(itr != m_idx.end(), "member account does not exist.");
+
+  m_idx.modify(itr, 0, [&](auto &c) {
+    settle_rewards(c);
+  });
+  METER_ROW(MT_MEMBERS, writes, *itr);
+}
+
+/*
+*   Pays everything rewarded since the member's checkpoint out of dac_funds_rewards and credits it to
+*   member_balance - call from inside a modify of their row
+*   A lapsed member only has their checkpoint moved on, the same as extend_membership does on reinstatement
+*/
+void ednadac::settle_rewards(member &c){
+  uint128_t acc = get_config().reward_per_member;
+  if (acc == c.reward_checkpoint){
+    return;
+  }
+
+  asset owed = asset{static_cast<int64_t>((acc - c.reward_checkpoint) / REWARD_SCALE), c.member_balance.symbol};
+  c.reward_checkpoint = acc;
+  if (owed.amount == 0 || c.member_status == MEM_LAPSED){                      // lapsed members are not in the member_count rewardall divides by
+    return;
+  }
+
+  edit_config().dac_funds_rewards -= owed;
+  sub_balance(_self, owed);
+  add_balance(c.account, owed, _self);
+  c.member_balance += owed;
+  c.total_value_earned += owed;
+}
+
+/*******************************************************************************
+ * News Feed *******************************************************************
+ *******************************************************************************/
+
+// writes a feed item that expires news_ttl from now into the next ring slot, overwriting the oldest item in place
+void ednadac::post_news(uint8_t news_type, uint64_t member_id, uint64_t ref_id, const string &text){
+  auto &cfg = edit_config();
+  uint64_t slot = cfg.news_next % cfg.news_capacity;
+  cfg.news_next += 1;
+
+  auto fill = [&](auto &c) {
+    c.news_id = slot;
+    c.news_type = news_type;
+    c.member_id = member_id;
+    c.news_ref = ref_id;
+    c.news_text = text;
+    c.news_ttl = now() + cfg.news_ttl;
+  };
+
+  news_table n_t(_self, _self);
+  auto itr = n_t.find(slot);
+  METER(MT_NEWSS, reads);
+  if (itr == n_t.end()){                                                        // slot never used or pruned after expiring
+    itr = n_t.emplace(_self, fill);
+    METER_ROW(MT_NEWSS, emplaces, *itr);
+  }
+  else {
+    n_t.modify(itr, 0, fill);
+    METER_ROW(MT_NEWSS, writes, *itr);
+  }
+}
+
+// erases up to max_rows expired feed items, oldest expiry first
+uint32_t ednadac::prune_news(uint32_t max_rows){
+  news_table n_t(_self, _self);
+  auto n_idx = n_t.get_index<N(byexpiry)>();
+  uint32_t erased = 0;
+
+  auto itr = n_idx.begin();
+  while (itr != n_idx.end() && itr->news_ttl <= now() && erased < max_rows)
+  {
+    itr = n_idx.erase(itr);
+    METER(MT_NEWSS, erases);
+    erased++;
+  }
+  return erased;
+}
+
 // Proposal management actions
 
-void ednadac::new_general_proposal(account_name _from, string _title, string _text){
+void ednadac::newgenprop(account_name _from, string _title, string _text){
+  require_auth(_from);
 
   uint64_t member_id;
   uint32_t mem_vote_ttl;
 
   member_table m_t(_self, _self);
-  auto itr = m_t.find(_from);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto itr = m_idx.find(_from);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(itr->member_status != MEM_LAPSED && itr->renewal_date >= now(), "membership expired, please renew.");
   member_id = itr->member_id;
 
-  config_table c_t (_self, _self);
-  auto c_itr = c_t.find(0);
-  mem_vote_ttl = c_itr->mem_vote_ttl;
+  mem_vote_ttl = get_config().mem_vote_ttl;
 
   proposal_table p_t(_self, _self);
-  p_t.emplace(_self, [&](auto &c) {
+  uint64_t prop_id = p_t.available_primary_key();
+  auto p_itr = p_t.emplace(_self, [&](auto &c) {
 
-    c.prop_id = p_t.available_primary_key();
+    c.prop_id = prop_id;
     c.sponsor_id = member_id;
     c.prop_type = GENERAL_PROPOSAL;
     c.prop_status = GEN_NEW;
     c.prop_title = _title;
-    c.prop_ipfs_text = _text;
+    c.prop_ipfs_text = ipfs_decode(_text);
     c.prop_gen_total_votes = 0;
+    c.prop_gen_yes_count = 0;
+    c.prop_gen_no_count = 0;
+    c.prop_cus_total_votes = 0;
+    c.prop_cus_yes_count = 0;
+    c.prop_cus_no_count = 0;
+    c.prop_ref_total_votes = 0;
+    c.prop_ref_yes_count = 0;
+    c.prop_ref_no_count = 0;
     c.prop_next_action_date = mem_vote_ttl + now();
   });
+  METER_ROW(MT_PROPOSALS, emplaces, *p_itr);
+
+  schedule_job(JOB_PROP_CHECK, prop_id, mem_vote_ttl + now());
 }
 
-void ednadac::vote_gen_prop(account_name _account, uint64_t prop_id, uint8_t vote ){
+void ednadac::votegenprop(account_name _account, uint64_t prop_id, uint8_t vote ){
+  require_auth(_account);
+  eosio_assert(vote == VOTE_NO || vote == VOTE_YES, "invalid vote.");
 
-  config_table c_t(_self, _self);
-  auto c_itr = c_t.find(0);
+  const auto &cfg = get_config();
 
-  auto ttl_escalated = c_itr->custodian_vote_ttl + now();
-  auto total_mem = c_itr->member_count;
-  auto prop_to_cust_target = c_itr->proposal_escalation;
-  auto target = ((prop_to_cust_target*1000)/(total_mem*1000));
+  auto ttl_escalated = cfg.custodian_vote_ttl + now();
+  auto target = cfg.escalation_votes;                                            // precomputed whenever member_count or the % changes
 
-  vote_table v_t(_self, _account);
-  auto v_itr = v_t.find(prop_id);
-  if (v_itr == v_t.end())
+  proposal_table p_t(_self, _self);
+  auto p_itr = p_t.find(prop_id);
+  METER(MT_PROPOSALS, reads);
+  eosio_assert(p_itr != p_t.end(), "proposal does not exist.");
+  eosio_assert(p_itr->prop_status == GEN_NEW && p_itr->prop_next_action_date > now(), "proposal is not open for member voting.");
+  bool escalated = false;
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(m_itr->member_status != MEM_LAPSED && m_itr->renewal_date >= now(), "membership expired, please renew.");
+  uint64_t member_id = m_itr->member_id;
+
+  vote_table v_t(_self, _self);
+  auto v_idx = v_t.get_index<N(propmember)>();
+  auto v_itr = v_idx.find(vote::prop_member_key(GENERAL_PROPOSAL, prop_id, member_id));
+  METER(MT_VOTES, reads);
+  if (v_itr == v_idx.end())
   {
-      v_t.emplace(_account, [&](auto &c) {
+      auto new_vote = v_t.emplace(_account, [&](auto &c) {
           c.vote_id = v_t.available_primary_key();
+          c.elect_id = 0;
           c.prop_type = GENERAL_PROPOSAL;
           c.prop_id = prop_id;
+          c.member_id = member_id;
           c.how_vote = vote;
       });
-      proposal_table p_t(_self, _self);                                         //need to upate the table holding the prop to add a vote to it's count
-      auto p_itr = p_t.find(prop_id);
-      p_t.modify(p_itr, _account, [&](auto &p) {
+      METER_ROW(MT_VOTES, emplaces, *new_vote);
+      p_t.modify(p_itr, 0, [&](auto &p) {                                       //first vote - add it to the running tallies
           p.prop_gen_total_votes += 1;                                          //this additional vote could push it's count over the config table and require it to "flip" to a custodial prop
-          if ((p.prop_gen_total_votes*1000) >= target){                         // I THINK this math is correct need to test
+          if (vote == VOTE_YES){
+            p.prop_gen_yes_count += 1;
+          }
+          else {
+            p.prop_gen_no_count += 1;
+          }
+          if (p.prop_gen_total_votes >= target){
             p.prop_type = CUSTODIAL_MATTER;                                     //tag it as custodial and give the members a choice to hold or archive thir vote on this proposal
             p.prop_status = GEN_ESCALATED;
             p.prop_next_action_date = ttl_escalated;
-          news_table n_t(_self, _self);                                     //add the announcement
-            n_t.emplace(_self, [&](auto &c) {
-                c.news_id = n_t.available_primary_key();
-                c.news_type = GEN_PROP_ESCALATED;
-                c.news_text = prop_id;
-                c.news_ttl = vote;
-            });
+            escalated = true;
+            post_news(GEN_PROP_ESCALATED, p.sponsor_id, prop_id, p.prop_title); //add the announcement
       }
   });
+  METER_ROW(MT_PROPOSALS, writes, *p_itr);
+  if (escalated){                                                               // hold window ends before the member voting window did
+    retime_job(JOB_PROP_CHECK, prop_id, ttl_escalated);
+  }
 }
-else
+else if (v_itr->how_vote != vote)
 {
-      v_t.modify(v_itr, _account, [&](auto &c) {
+      v_idx.modify(v_itr, 0, [&](auto &c) {
           c.how_vote = vote;
       });
+      METER_ROW(MT_VOTES, writes, *v_itr);
+      p_t.modify(p_itr, 0, [&](auto &p) {                                       //changed vote - move it from one tally to the other, total is unchanged
+          if (vote == VOTE_YES){
+            p.prop_gen_no_count -= 1;
+            p.prop_gen_yes_count += 1;
+          }
+          else {
+            p.prop_gen_yes_count -= 1;
+            p.prop_gen_no_count += 1;
+          }
+      });
+      METER_ROW(MT_PROPOSALS, writes, *p_itr);
+}
+
+}
+
+/*
+*   Sitting custodians vote on escalated proposals while they are CUST_NEW or stalled. The proposal is decided
+*   by the vote that takes either side to custodial_majority - the stall states are only reached on a timeout
+*/
+void ednadac::custvote(account_name _account, uint64_t prop_id, uint8_t vote){
+  require_auth(_account);
+  eosio_assert(vote == VOTE_NO || vote == VOTE_YES, "invalid vote.");
+
+  const auto &cfg = get_config();
+
+  proposal_table p_t(_self, _self);
+  auto p_itr = p_t.find(prop_id);
+  METER(MT_PROPOSALS, reads);
+  eosio_assert(p_itr != p_t.end(), "proposal does not exist.");
+  eosio_assert(p_itr->prop_status == CUST_NEW || p_itr->prop_status == CUSTO_STALLED_1
+               || p_itr->prop_status == CUSTO_STALLED_2 || p_itr->prop_status == CUSTO_STALLED_3, "proposal is not open for custodial voting.");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(m_itr->member_status != MEM_LAPSED && m_itr->renewal_date >= now(), "membership expired, please renew.");
+  eosio_assert(m_itr->custodial_status == CUSTO_SITTING, "only sitting custodians may vote on custodial matters.");
+  uint64_t member_id = m_itr->member_id;
+
+  vote_table v_t(_self, _self);
+  auto v_idx = v_t.get_index<N(propmember)>();
+  auto v_itr = v_idx.find(vote::prop_member_key(CUSTODIAL_MATTER, prop_id, member_id));
+  METER(MT_VOTES, reads);
+  bool first_vote = (v_itr == v_idx.end());
+  if (first_vote)
+  {
+    auto new_vote = v_t.emplace(_account, [&](auto &c) {
+      c.vote_id = v_t.available_primary_key();
+      c.elect_id = 0;
+      c.prop_type = CUSTODIAL_MATTER;
+      c.prop_id = prop_id;
+      c.member_id = member_id;
+      c.how_vote = vote;
+    });
+    METER_ROW(MT_VOTES, emplaces, *new_vote);
+  }
+  else
+  {
+    if (v_itr->how_vote == vote){
+      return;
+    }
+    v_idx.modify(v_itr, 0, [&](auto &c) {
+      c.how_vote = vote;
+    });
+    METER_ROW(MT_VOTES, writes, *v_itr);
+  }
+
+  p_t.modify(p_itr, 0, [&](auto &p) {
+    if (first_vote){
+      p.prop_cus_total_votes += 1;
+    }
+    else if (vote == VOTE_YES){                                                 // changed vote - take it back off the other side
+      p.prop_cus_no_count -= 1;
+    }
+    else {
+      p.prop_cus_yes_count -= 1;
+    }
+    if (vote == VOTE_YES){
+      p.prop_cus_yes_count += 1;
+    }
+    else {
+      p.prop_cus_no_count += 1;
+    }
+
+    if (p.prop_cus_yes_count >= cfg.custodial_majority){                        // decided - the queued check finds nothing left to do
+      p.prop_status = CUSTO_PASSED;
+      p.prop_next_action_date = PROP_NO_ACTION;
+    }
+    else if (p.prop_cus_no_count >= cfg.custodial_majority){
+      p.prop_status = CUSTO_DEFEATED;
+      p.prop_next_action_date = PROP_NO_ACTION;
+    }
+  });
+  METER_ROW(MT_PROPOSALS, writes, *p_itr);
 }
 
+/*
+*   Referendum votes only touch one tally shard, the proposal row is read but not written until the referendum closes.
+*   The shard is kept on the ballot in elect_id so a changed vote is taken back from the same row after ref_shards changes
+*/
+void ednadac::refvote(account_name _account, uint64_t prop_id, uint8_t vote){
+  require_auth(_account);
+  eosio_assert(vote == VOTE_NO || vote == VOTE_YES, "invalid vote.");
+
+  proposal_table p_t(_self, _self);
+  auto p_itr = p_t.find(prop_id);
+  METER(MT_PROPOSALS, reads);
+  eosio_assert(p_itr != p_t.end(), "proposal does not exist.");
+  eosio_assert(p_itr->prop_status == REF_CREATED && p_itr->prop_next_action_date > now(), "proposal is not open for referendum voting.");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(m_itr->member_status != MEM_LAPSED && m_itr->renewal_date >= now(), "membership expired, please renew.");
+  uint64_t member_id = m_itr->member_id;
+
+  vote_table v_t(_self, _self);
+  auto v_idx = v_t.get_index<N(propmember)>();
+  auto v_itr = v_idx.find(vote::prop_member_key(REFERENDUM, prop_id, member_id));
+  METER(MT_VOTES, reads);
+
+  reftally_table r_t(_self, prop_id);
+  if (v_itr == v_idx.end())
+  {
+    uint64_t shard = member_id % get_config().ref_shards;
+    auto new_vote = v_t.emplace(_account, [&](auto &c) {
+      c.vote_id = v_t.available_primary_key();
+      c.elect_id = shard;
+      c.prop_type = REFERENDUM;
+      c.prop_id = prop_id;
+      c.member_id = member_id;
+      c.how_vote = vote;
+    });
+    METER_ROW(MT_VOTES, emplaces, *new_vote);
+
+    auto r_itr = r_t.find(shard);
+    if (r_itr == r_t.end())
+    {
+      r_t.emplace(_account, [&](auto &r) {
+        r.shard = shard;
+        r.yes_count = (vote == VOTE_YES) ? 1 : 0;
+        r.no_count = (vote == VOTE_NO) ? 1 : 0;
+      });
+    }
+    else
+    {
+      r_t.modify(r_itr, 0, [&](auto &r) {
+        if (vote == VOTE_YES){
+          r.yes_count += 1;
+        }
+        else {
+          r.no_count += 1;
+        }
+      });
+    }
+  }
+  else if (v_itr->how_vote != vote)
+  {
+    v_idx.modify(v_itr, 0, [&](auto &c) {
+      c.how_vote = vote;
+    });
+    METER_ROW(MT_VOTES, writes, *v_itr);
+    r_t.modify(r_t.get(v_itr->elect_id), 0, [&](auto &r) {                     // changed vote - move it between tallies on its own shard
+      if (vote == VOTE_YES){
+        r.no_count -= 1;
+        r.yes_count += 1;
+      }
+      else {
+        r.yes_count -= 1;
+        r.no_count += 1;
+      }
+    });
+  }
 }
 
 
 
 
-void ednadac::general_proposal_check(){
+void ednadac::genpropcheck(uint32_t _max_rows){
+  eosio_assert(_max_rows > 0 && _max_rows <= MAX_SWEEP_ROWS, "invalid number of rows to sweep.");
+  sweep_proposals(_max_rows);
+}
+
+// walks proposals in deadline order and moves up to max_rows expired ones to their next state
+// rows that stay open get a later deadline, so a repeated call resumes where the last one stopped
+uint32_t ednadac::sweep_proposals(uint32_t max_rows){
+  const auto &cfg = get_config();
+
+  proposal_table p_t(_self, _self);
+  auto p_idx = p_t.get_index<N(deadline)>();
+  uint32_t processed = 0;
 
+  auto itr = p_idx.begin();
+  while (itr != p_idx.end() && itr->prop_next_action_date <= now() && processed < max_rows)
+  {
+    METER(MT_PROPOSALS, reads);
+    p_idx.modify(itr, 0, [&](auto &p) {
+      advance_proposal(p, cfg);
+    });
+    METER_ROW(MT_PROPOSALS, writes, *itr);
+    processed++;
+    itr = p_idx.begin();
+  }
+  return processed;
+}
 
+// moves one expired proposal to its next state and sets its next deadline
+void ednadac::advance_proposal(proposal &p, const config &c){
+  if (p.prop_status == GEN_NEW){                                                // member voting window closed
+    if (p.prop_gen_total_votes >= c.escalation_votes){
+      p.prop_type = CUSTODIAL_MATTER;
+      p.prop_status = GEN_ESCALATED;
+      p.prop_next_action_date = now() + c.custodian_vote_ttl;
+      post_news(GEN_PROP_ESCALATED, p.sponsor_id, p.prop_id, p.prop_title);
+    }
+    else {
+      p.prop_status = GEN_UNSUPPORTED;
+      p.prop_next_action_date = PROP_NO_ACTION;
+    }
+  }
+  else if (p.prop_status == GEN_ESCALATED){                                     // hold window over - hand to the custodians
+    p.prop_status = CUST_NEW;
+    p.prop_next_action_date = now() + c.custodian_vote_ttl;
+  }
+  else if (p.prop_status == CUST_NEW){
+    p.prop_status = CUSTO_STALLED_1;
+    p.prop_next_action_date = now() + c.custodian_vote_ttl;
+  }
+  else if (p.prop_status == CUSTO_STALLED_1){
+    p.prop_status = CUSTO_STALLED_2;
+    p.prop_next_action_date = now() + c.custodian_vote_ttl;
+  }
+  else if (p.prop_status == CUSTO_STALLED_2){
+    p.prop_status = CUSTO_STALLED_3;
+    p.prop_next_action_date = now() + c.custodian_vote_ttl;
+  }
+  else if (p.prop_status == CUSTO_STALLED_3){                                   // custodians could not decide - put it to the members
+    p.prop_type = REFERENDUM;
+    p.prop_status = REF_CREATED;
+    p.prop_next_action_date = now() + c.mem_vote_ttl;
+  }
+  else if (p.prop_status == REF_CREATED){
+    close_referendum(p, c);
+  }
+  else {                                                                        // closed states need no further action
+    p.prop_next_action_date = PROP_NO_ACTION;
+  }
+}
 
+// merges and frees the tally shards of a closed referendum - at most ref_shards rows
+void ednadac::close_referendum(proposal &p, const config &c){
+  reftally_table r_t(_self, p.prop_id);
+  uint32_t yes = 0;
+  uint32_t no = 0;
+  auto itr = r_t.begin();
+  while (itr != r_t.end())
+  {
+    yes += itr->yes_count;
+    no += itr->no_count;
+    itr = r_t.erase(itr);
+  }
+
+  p.prop_ref_yes_count = yes;
+  p.prop_ref_no_count = no;
+  p.prop_ref_total_votes = yes + no;
+  p.prop_status = (yes >= c.referendum_votes) ? REF_PASSED : REF_DEFEATED;
+  p.prop_next_action_date = PROP_NO_ACTION;
 }
 
 /*
@@ -443,15 +1621,18 @@ void ednadac::sub_balance(account_name owner, asset value)
 {
     accounts from_acnts(_self, owner);
     const auto &from = from_acnts.get(value.symbol.name(), "no balance object found");
+    METER(MT_ACCOUNTS, reads);
     eosio_assert(from.balance.amount >= value.amount, "overdrawn balance");
 
     if (from.balance.amount == value.amount){
         from_acnts.erase(from);
+        METER(MT_ACCOUNTS, erases);
     }
     else {
         from_acnts.modify(from, owner, [&](auto &a) {
             a.balance -= value;
         });
+        METER_ROW(MT_ACCOUNTS, writes, from);
     }
 }
 /*
@@ -461,16 +1642,536 @@ void ednadac::add_balance(account_name owner, asset value, account_name ram_paye
 {
     accounts to_acnts(_self, owner);
     auto to = to_acnts.find(value.symbol.name());
+    METER(MT_ACCOUNTS, reads);
     if (to == to_acnts.end())
     {
-        to_acnts.emplace(ram_payer, [&](auto &a) {
+        to = to_acnts.emplace(ram_payer, [&](auto &a) {
             a.balance = value;
         });
+        METER_ROW(MT_ACCOUNTS, emplaces, *to);
     }
     else
     {
         to_acnts.modify(to, 0, [&](auto &a) {
             a.balance += value;
         });
+        METER_ROW(MT_ACCOUNTS, writes, *to);
+    }
+}
+
+
+/*******************************************************************************
+ * Custodian Elections *********************************************************
+ *******************************************************************************/
+
+void ednadac::newelection(){
+  require_auth(_self);
+  const auto &cfg = get_config();
+
+  election_table e_t(_self, _self);
+  auto last = e_t.end();
+  eosio_assert(last == e_t.begin() || (--last)->election_status == ELECT_HISTORY, "an election is already in progress.");
+
+  uint64_t election_id = e_t.available_primary_key();
+  uint64_t due = now() + cfg.nominations_ttl;
+  e_t.emplace(_self, [&](auto &e) {
+    e.election_id = election_id;
+    e.election_status = ELECT_NOMINATING;
+    e.next_action_date = due;
+    e.defeat_cursor = 0;
+  });
+
+  schedule_job(JOB_ELECTION_CHECK, election_id, due);
+}
+
+void ednadac::nominate(account_name _account, uint64_t _election_id){
+  require_auth(_account);
+
+  election_table e_t(_self, _self);
+  auto e_itr = e_t.find(_election_id);
+  eosio_assert(e_itr != e_t.end(), "election does not exist.");
+  eosio_assert(e_itr->election_status == ELECT_NOMINATING && e_itr->next_action_date > now(), "election is not taking nominations.");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(m_itr->renewal_date >= now(), "membership expired, please renew.");
+  eosio_assert(m_itr->custodial_status != CUSTO_REMOVED && m_itr->custodial_status != CUSTO_RETIRED, "member may not be nominated.");
+  uint64_t member_id = m_itr->member_id;
+
+  elemembxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(bycandidate)>();
+  eosio_assert(x_idx.find(((uint128_t)_election_id << 64) | member_id) == x_idx.end(), "member is already a candidate.");
+
+  x_t.emplace(_account, [&](auto &x) {
+    x.elemembxref_id = x_t.available_primary_key();
+    x.election_id = _election_id;
+    x.member_id = member_id;
+    x.votes = 0;
+    x.elected = 0;
+  });
+
+  if (m_itr->custodial_status != CUSTO_SITTING){                                // sitting custodians stay seated until tabulation
+    m_idx.modify(m_itr, 0, [&](auto &c) {
+      c.custodial_status = CUSTO_RUNNING;
+    });
+    METER_ROW(MT_MEMBERS, writes, *m_itr);
+  }
+
+  post_news(CUST_RUNNING, member_id, _election_id, "");
+}
+
+// one ballot per member per election - a changed ballot moves the vote between candidates
+void ednadac::votecust(account_name _account, uint64_t _election_id, account_name _candidate){
+  require_auth(_account);
+
+  election_table e_t(_self, _self);
+  auto e_itr = e_t.find(_election_id);
+  eosio_assert(e_itr != e_t.end(), "election does not exist.");
+  eosio_assert(e_itr->election_status == ELECT_VOTING && e_itr->next_action_date > now(), "election is not open for voting.");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(m_itr->renewal_date >= now(), "membership expired, please renew.");
+  uint64_t member_id = m_itr->member_id;
+
+  auto c_itr = m_idx.find(_candidate);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(c_itr != m_idx.end(), "candidate is not a member.");
+
+  elemembxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(bycandidate)>();
+  auto x_itr = x_idx.find(((uint128_t)_election_id << 64) | c_itr->member_id);
+  eosio_assert(x_itr != x_idx.end(), "member is not a candidate in this election.");
+  uint64_t xref_id = x_itr->elemembxref_id;
+
+  vote_table v_t(_self, _self);
+  auto v_idx = v_t.get_index<N(propmember)>();
+  auto v_itr = v_idx.find(vote::prop_member_key(ELECTION_BALLOT, _election_id, member_id));
+  METER(MT_VOTES, reads);
+  if (v_itr == v_idx.end())
+  {
+    auto new_vote = v_t.emplace(_account, [&](auto &v) {
+      v.vote_id = v_t.available_primary_key();
+      v.elect_id = xref_id;
+      v.prop_id = _election_id;
+      v.prop_type = ELECTION_BALLOT;
+      v.member_id = member_id;
+      v.how_vote = VOTE_YES;
+    });
+    METER_ROW(MT_VOTES, emplaces, *new_vote);
+  }
+  else
+  {
+    if (v_itr->elect_id == xref_id){
+      return;
+    }
+    auto old_itr = x_t.find(v_itr->elect_id);
+    if (old_itr != x_t.end()){                                                  // take the vote back from the old choice, unless archived
+      x_t.modify(old_itr, 0, [&](auto &x) {
+        x.votes -= 1;
+      });
+    }
+    v_idx.modify(v_itr, 0, [&](auto &v) {
+      v.elect_id = xref_id;
+    });
+    METER_ROW(MT_VOTES, writes, *v_itr);
+  }
+
+  x_idx.modify(x_itr, 0, [&](auto &x) {
+    x.votes += 1;
+  });
+}
+
+void ednadac::tabulate(uint64_t _election_id){
+  election_table e_t(_self, _self);
+  auto e_itr = e_t.find(_election_id);
+  eosio_assert(e_itr != e_t.end(), "election does not exist.");
+  eosio_assert(e_itr->election_status == ELECT_TABULATING || e_itr->election_status == ELECT_DEFEATING
+               || (e_itr->election_status == ELECT_VOTING && e_itr->next_action_date <= now()), "election is not ready to tabulate.");
+
+  if (e_itr->election_status == ELECT_VOTING){
+    e_t.modify(e_itr, 0, [&](auto &e) {
+      e.election_status = ELECT_TABULATING;
+    });
+  }
+  advance_election(_election_id);
+}
+
+// moves an election on once its window closes - returns when it next needs looking at, 0 when finished
+uint64_t ednadac::advance_election(uint64_t election_id){
+  election_table e_t(_self, _self);
+  auto e_itr = e_t.find(election_id);
+  if (e_itr == e_t.end() || e_itr->election_status == ELECT_HISTORY){
+    return 0;
+  }
+  if (e_itr->election_status != ELECT_TABULATING && e_itr->election_status != ELECT_DEFEATING && e_itr->next_action_date > now()){
+    return e_itr->next_action_date;
+  }
+
+  if (e_itr->election_status == ELECT_NOMINATING){
+    uint64_t due = now() + get_config().elections_ttl;
+    e_t.modify(e_itr, 0, [&](auto &e) {
+      e.election_status = ELECT_VOTING;
+      e.next_action_date = due;
+    });
+    return due;
+  }
+
+  if (e_itr->election_status != ELECT_DEFEATING){                                // voting closed or tabulation requested
+    seat_custodians(election_id);
+  }
+
+  uint64_t cursor = e_itr->defeat_cursor;
+  bool finished = defeat_candidates(election_id, cursor, MAX_SWEEP_ROWS);
+  e_t.modify(e_itr, 0, [&](auto &e) {
+    e.election_status = finished ? ELECT_HISTORY : ELECT_DEFEATING;
+    e.next_action_date = now();
+    e.defeat_cursor = cursor;
+  });
+  return finished ? 0 : now() + 1;
+}
+
+/*
+*   Unseats the custodians_seated custodians of the previous election, then seats the top custodian_count
+*   candidates of this one with a single reverse walk of the byvotes index - no ballots are counted, the
+*   candidates below the seats are left to defeat_candidates
+*/
+void ednadac::seat_custodians(uint64_t election_id){
+  auto &cfg = edit_config();
+  member_table m_t(_self, _self);
+  elemembxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(byvotes)>();
+
+  if (cfg.last_election_id != NO_ELECTION){
+    uint32_t unseated = 0;
+    auto prev = x_idx.lower_bound((uint128_t)(cfg.last_election_id + 1) << 64);
+    while (prev != x_idx.begin() && unseated < cfg.custodians_seated)
+    {
+      --prev;
+      if (prev->election_id != cfg.last_election_id){
+        break;
+      }
+      if (prev->elected == 0){                                                  // skipped when archived before seating
+        continue;
+      }
+      unseated++;
+      auto m_itr = m_t.find(prev->member_id);
+      METER(MT_MEMBERS, reads);
+      if (m_itr != m_t.end() && m_itr->custodial_status == CUSTO_SITTING){
+        m_t.modify(m_itr, 0, [&](auto &c) {
+          c.custodial_status = CUSTO_NONE;
+        });
+        METER_ROW(MT_MEMBERS, writes, *m_itr);
+      }
+    }
+  }
+
+  uint32_t seated = 0;
+  auto itr = x_idx.lower_bound((uint128_t)(election_id + 1) << 64);
+  while (itr != x_idx.begin() && seated < cfg.custodian_count)
+  {
+    --itr;
+    if (itr->election_id != election_id || itr->votes == 0){
+      break;
+    }
+    auto m_itr = m_t.find(itr->member_id);
+    METER(MT_MEMBERS, reads);
+    if (m_itr == m_t.end()){                                                    // archived since nominating
+      continue;
+    }
+    m_t.modify(m_itr, 0, [&](auto &c) {
+      c.custodial_status = CUSTO_SITTING;
+    });
+    METER_ROW(MT_MEMBERS, writes, *m_itr);
+    x_t.modify(x_t.get(itr->elemembxref_id), 0, [&](auto &x) {               // elected is not part of the byvotes key
+      x.elected = 1;
+    });
+    seated++;
+  }
+
+  cfg.custodians_seated = seated;
+  cfg.last_election_id = election_id;
+  cfg.next_election_due = now() + cfg.custodian_ttl;
+}
+
+/*
+*   Marks up to max_rows of an election's losing candidates defeated, walking bycandidate from cursor - sitting
+*   custodians who ran and lost were already moved to CUSTO_NONE by seat_custodians. Returns true when done
+*/
+bool ednadac::defeat_candidates(uint64_t election_id, uint64_t &cursor, uint32_t max_rows){
+  member_table m_t(_self, _self);
+  elemembxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(bycandidate)>();
+  auto itr = x_idx.lower_bound(((uint128_t)election_id << 64) | cursor);
+  uint32_t processed = 0;
+
+  while (itr != x_idx.end() && itr->election_id == election_id && processed < max_rows)
+  {
+    if (itr->elected == 0){
+      auto m_itr = m_t.find(itr->member_id);
+      METER(MT_MEMBERS, reads);
+      if (m_itr != m_t.end() && (m_itr->custodial_status == CUSTO_RUNNING || m_itr->custodial_status == CUSTO_NONE)){
+        m_t.modify(m_itr, 0, [&](auto &c) {
+          c.custodial_status = CUSTO_DEFETED;
+        });
+        METER_ROW(MT_MEMBERS, writes, *m_itr);
+      }
+    }
+    cursor = itr->member_id + 1;
+    processed++;
+    ++itr;
+  }
+
+  return (itr == x_idx.end() || itr->election_id != election_id);
+}
+
+/*******************************************************************************
+ * Research Opt-In *************************************************************
+ *******************************************************************************/
+
+void ednadac::optin(account_name _account, uint64_t _research_id){
+  require_auth(_account);
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  eosio_assert(m_itr->renewal_date >= now(), "membership expired, please renew.");
+  uint64_t member_id = m_itr->member_id;
+
+  research_table r_t(_self, _self);
+  auto r_itr = r_t.find(_research_id);
+  eosio_assert(r_itr != r_t.end(), "research does not exist.");
+  eosio_assert(r_itr->research_status == RESEARCH_ACCEPTING_OPT_IN, "research is not accepting opt-ins.");
+  eosio_assert(r_itr->number_of_opt_ins < r_itr->number_genomes_sought, "research has all the genomes it is seeking.");
+
+  resmemxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(byresearch)>();
+  eosio_assert(x_idx.find(((uint128_t)_research_id << 64) | member_id) == x_idx.end(), "member already opted in to this research.");
+
+  x_t.emplace(_account, [&](auto &x) {
+    x.xref_id = x_t.available_primary_key();
+    x.research_id = _research_id;
+    x.member_id = member_id;
+  });
+
+  r_t.modify(r_itr, 0, [&](auto &r) {
+    r.number_of_opt_ins += 1;
+  });
+  m_idx.modify(m_itr, 0, [&](auto &c) {
+    c.research_opt_in_count += 1;
+  });
+  METER_ROW(MT_MEMBERS, writes, *m_itr);
+}
+
+void ednadac::optout(account_name _account, uint64_t _research_id){
+  require_auth(_account);
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  uint64_t member_id = m_itr->member_id;
+
+  research_table r_t(_self, _self);
+  auto r_itr = r_t.find(_research_id);
+  eosio_assert(r_itr != r_t.end(), "research does not exist.");
+  eosio_assert(r_itr->research_status == RESEARCH_ACCEPTING_OPT_IN, "research is no longer accepting changes to opt-ins.");
+
+  resmemxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(byresearch)>();
+  auto x_itr = x_idx.find(((uint128_t)_research_id << 64) | member_id);
+  eosio_assert(x_itr != x_idx.end(), "member has not opted in to this research.");
+  x_idx.erase(x_itr);
+
+  r_t.modify(r_itr, 0, [&](auto &r) {
+    r.number_of_opt_ins -= 1;
+  });
+  m_idx.modify(m_itr, 0, [&](auto &c) {
+    c.research_opt_in_count -= 1;
+  });
+  METER_ROW(MT_MEMBERS, writes, *m_itr);
+}
+
+/*
+*   Moves a completed research's proposed_payment from _from into the contract's balance and sets it
+*   aside in payout_funds for distribute - the research moves to RESEARCH_PAID
+*/
+void ednadac::fundresearch(account_name _from, uint64_t _research_id){
+  require_auth(_from);
+
+  research_table r_t(_self, _self);
+  auto r_itr = r_t.find(_research_id);
+  eosio_assert(r_itr != r_t.end(), "research does not exist.");
+  eosio_assert(r_itr->research_status == RESEARCH_COMPLETE, "research is not ready for payment.");
+  eosio_assert(r_itr->proposed_payment.is_valid() && r_itr->proposed_payment.amount > 0, "research has no payment to fund.");
+  eosio_assert(r_itr->proposed_payment.symbol == get_config().dac_funds_main.symbol, "symbol precision mismatch");
+
+  sub_balance(_from, r_itr->proposed_payment);
+  add_balance(_self, r_itr->proposed_payment, _from);
+
+  r_t.modify(r_itr, 0, [&](auto &r) {
+    r.payout_funds = r.proposed_payment;
+    r.research_status = RESEARCH_PAID;
+  });
+}
+
+/*
+*   Pays a research's proposed_payment out evenly to its opt-in cohort, at most _max_rows members per call
+*   The payment is drawn from the payout_funds fundresearch set aside - payout_cursor lets a large cohort be
+*   paid over as many transactions as it takes, the research moves to RESEARCH_PMT_DISTRIBUTED when done
+*/
+void ednadac::distribute(uint64_t _research_id, uint32_t _max_rows){
+  require_auth(_self);
+  eosio_assert(_max_rows > 0 && _max_rows <= MAX_SWEEP_ROWS, "invalid number of rows to distribute.");
+
+  research_table r_t(_self, _self);
+  auto r_itr = r_t.find(_research_id);
+  eosio_assert(r_itr != r_t.end(), "research does not exist.");
+  eosio_assert(r_itr->research_status == RESEARCH_PAID, "research payment is not ready for distribution.");
+  eosio_assert(r_itr->number_of_opt_ins > 0, "research has no opted in members.");
+
+  asset share = r_itr->payout_share;
+  if (share.amount == 0){                                                       // first chunk - any remainder stays with the DAC
+    share = r_itr->proposed_payment;
+    share.amount /= r_itr->number_of_opt_ins;
+    eosio_assert(share.amount > 0, "payment is too small to share between the opted in members.");
+  }
+
+  member_table m_t(_self, _self);
+  resmemxref_table x_t(_self, _self);
+  auto x_idx = x_t.get_index<N(byresearch)>();
+  auto x_itr = x_idx.lower_bound(((uint128_t)_research_id << 64) | r_itr->payout_cursor);
+
+  asset total = asset{static_cast<int64_t>(0), share.symbol};
+  uint64_t cursor = r_itr->payout_cursor;
+  uint32_t processed = 0;
+  while (x_itr != x_idx.end() && x_itr->research_id == _research_id && processed < _max_rows)
+  {
+    auto m_itr = m_t.find(x_itr->member_id);
+    METER(MT_MEMBERS, reads);
+    if (m_itr != m_t.end()){                                                    // archived members forfeit their share
+      add_balance(m_itr->account, share, _self);
+      m_t.modify(m_itr, 0, [&](auto &c) {
+        c.research_value_earned += share;
+        c.total_value_earned += share;
+      });
+      METER_ROW(MT_MEMBERS, writes, *m_itr);
+      total += share;
+    }
+    cursor = x_itr->member_id + 1;
+    processed++;
+    ++x_itr;
+  }
+
+  eosio_assert(total.amount <= r_itr->payout_funds.amount, "distribution exceeds the funds paid in for this research.");
+  if (total.amount > 0){
+    sub_balance(_self, total);
+  }
+
+  bool finished = (x_itr == x_idx.end() || x_itr->research_id != _research_id);
+  asset remainder = r_itr->payout_funds - total;
+  r_t.modify(r_itr, 0, [&](auto &r) {
+    r.payout_share = share;
+    r.payout_funds = finished ? asset{static_cast<int64_t>(0), remainder.symbol} : remainder;
+    r.payout_cursor = cursor;
+    if (finished){
+      r.research_status = RESEARCH_PMT_DISTRIBUTED;
+    }
+  });
+
+  if (finished && remainder.amount > 0){                                        // rounding and forfeited shares stay with the DAC
+    edit_config().dac_funds_main += remainder;
+  }
+}
+
+/*******************************************************************************
+ * Research Committees *********************************************************
+ *******************************************************************************/
+
+void ednadac::newcommittee(uint64_t _research_id){
+  require_auth(_self);
+
+  research_table r_t(_self, _self);
+  eosio_assert(r_t.find(_research_id) != r_t.end(), "research does not exist.");
+
+  rcommittee_table rc_t(_self, _self);
+  rc_t.emplace(_self, [&](auto &c) {
+    c.committee_id = rc_t.available_primary_key();
+    c.research_id = _research_id;
+    c.chairman_id = NO_MEMBER;
+    c.member_count = 0;
+  });
+}
+
+void ednadac::addcommember(uint64_t _committee_id, account_name _account, uint8_t _role){
+  require_auth(_self);
+  eosio_assert(_role == COMMITTEE_CHAIR || _role == COMMITTEE_MEMBER, "invalid committee role.");
+
+  rcommittee_table rc_t(_self, _self);
+  auto rc_itr = rc_t.find(_committee_id);
+  eosio_assert(rc_itr != rc_t.end(), "committee does not exist.");
+  eosio_assert(rc_itr->member_count < get_config().committee_size, "committee is full.");
+  eosio_assert(_role != COMMITTEE_CHAIR || rc_itr->chairman_id == NO_MEMBER, "committee already has a chair.");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  uint64_t member_id = m_itr->member_id;
+
+  rcommember_table rm_t(_self, _self);
+  auto rm_idx = rm_t.get_index<N(bycommittee)>();
+  eosio_assert(rm_idx.find(((uint128_t)_committee_id << 64) | member_id) == rm_idx.end(), "member already sits on this committee.");
+
+  rm_t.emplace(_self, [&](auto &c) {
+    c.rcommember_id = rm_t.available_primary_key();
+    c.committee_id = _committee_id;
+    c.member_id = member_id;
+    c.role = _role;
+  });
+
+  rc_t.modify(rc_itr, 0, [&](auto &c) {
+    c.member_count += 1;
+    if (_role == COMMITTEE_CHAIR){
+      c.chairman_id = member_id;
+    }
+  });
+}
+
+void ednadac::remcommember(uint64_t _committee_id, account_name _account){
+  require_auth(_self);
+
+  rcommittee_table rc_t(_self, _self);
+  auto rc_itr = rc_t.find(_committee_id);
+  eosio_assert(rc_itr != rc_t.end(), "committee does not exist.");
+
+  member_table m_t(_self, _self);
+  auto m_idx = m_t.get_index<N(byaccount)>();
+  auto m_itr = m_idx.find(_account);
+  METER(MT_MEMBERS, reads);
+  eosio_assert(m_itr != m_idx.end(), "member account does not exist.");
+  uint64_t member_id = m_itr->member_id;
+
+  rcommember_table rm_t(_self, _self);
+  auto rm_idx = rm_t.get_index<N(bycommittee)>();
+  auto rm_itr = rm_idx.find(((uint128_t)_committee_id << 64) | member_id);
+  eosio_assert(rm_itr != rm_idx.end(), "member does not sit on this committee.");
+  rm_idx.erase(rm_itr);
+
+  rc_t.modify(rc_itr, 0, [&](auto &c) {
+    c.member_count -= 1;
+    if (c.chairman_id == member_id){
+      c.chairman_id = NO_MEMBER;
     }
+  });
 }
@@ -9,16 +9,40 @@
 
 #include <eosiolib/asset.hpp>
 #include <eosiolib/eosio.hpp>
+#include <eosiolib/singleton.hpp>
+#include <eosiolib/transaction.hpp>
 #include <string>
 
 using namespace eosio;
 using std::string;
+using std::vector;
 using eosio::const_mem_fun;
 
+// optional per-action table accounting, enabled with -DEDNADAC_METRICS
+// METER counts reads and erases, every emplace or modify goes through METER_ROW so its bytes are counted with it
+#ifdef EDNADAC_METRICS
+#define METER(table, op)            (_meters[table].op += 1)
+#define METER_ROW(table, op, row)   (_meters[table].op += 1, _meters[table].bytes += eosio::pack_size(row))
+#else
+#define METER(table, op)
+#define METER_ROW(table, op, row)   ((void)sizeof(row))
+#endif
+
+// an IPFS reference stored as its raw 34 byte multihash rather than the 46 character base58 string
+// the website base58-encodes the bytes back into the usual Qm... form
+struct ipfshash
+{
+    vector<uint8_t> multihash;                                                  // hash_fn 0x12, hash_len 0x20 and the digest - empty when no hash is set
+
+    EOSLIB_SERIALIZE (ipfshash, (multihash));
+};
+
 class ednadac : public contract
 {
   public:
-    ednadac(account_name self) : contract(self) {}
+    ednadac(account_name self) : contract(self), _config_single(self, self) {}
+
+    ~ednadac();
 
     inline asset get_supply(symbol_name sym) const;
 
@@ -36,9 +60,35 @@ class ednadac : public contract
     // @abi action
     void addmember(account_name _account, string tele_user, asset quantity);
 
+    struct newmember {
+      account_name      account;
+      string            tele_user;
+      asset             dues;
+
+      EOSLIB_SERIALIZE (newmember, (account)(tele_user)(dues));
+    };
+
+    // @abi action
+    void addmembers(vector<newmember> _members);
+
+    // @abi action
+    void renewmembers(vector<account_name> _accounts);
+
     // @abi action
     void updatemember(account_name _account, uint8_t _upd_type, uint8_t _param_i8, uint32_t _param32, uint64_t _parm64, string _param_s, asset _param_asset);
 
+    struct memupdate {
+      uint8_t           field;                                                  // one of the member record update types below
+      uint8_t           param_i8;
+      string            param_s;
+      asset             param_asset;
+
+      EOSLIB_SERIALIZE (memupdate, (field)(param_i8)(param_s)(param_asset));
+    };
+
+    // @abi action
+    void updmemfields(account_name _account, vector<memupdate> _updates);
+
     // @abi action
     void deletemember(account_name _account);
 
@@ -48,6 +98,9 @@ class ednadac : public contract
     // @abi action
     void archivemem(account_name _account);
 
+    // @abi action
+    void memcheck(uint32_t _max_rows);
+
     // @abi action
     void newgenprop(account_name _from, string _title, string _text);
 
@@ -55,14 +108,95 @@ class ednadac : public contract
     void votegenprop(account_name _account, uint64_t prop_id, uint8_t vote);
 
     // @abi action
-    void genpropcheck();
+    void custvote(account_name _account, uint64_t prop_id, uint8_t vote);
+
+    // @abi action
+    void refvote(account_name _account, uint64_t prop_id, uint8_t vote);
+
+    // @abi action
+    void genpropcheck(uint32_t _max_rows);
+
+    // @abi action
+    void globalalarms();
+
+    // @abi action
+    void fundrewards(account_name _from, asset _quantity);
+
+    // @abi action
+    void rewardall(asset _quantity);
+
+    // @abi action
+    void claim(account_name _account);
+
+    // @abi action
+    void optin(account_name _account, uint64_t _research_id);
+
+    // @abi action
+    void optout(account_name _account, uint64_t _research_id);
+
+    // @abi action
+    void fundresearch(account_name _from, uint64_t _research_id);
+
+    // @abi action
+    void distribute(uint64_t _research_id, uint32_t _max_rows);
+
+    // @abi action
+    void newelection();
+
+    // @abi action
+    void nominate(account_name _account, uint64_t _election_id);
+
+    // @abi action
+    void votecust(account_name _account, uint64_t _election_id, account_name _candidate);
+
+    // @abi action
+    void tabulate(uint64_t _election_id);
+
+    // @abi action
+    void newcommittee(uint64_t _research_id);
+
+    // @abi action
+    void addcommember(uint64_t _committee_id, account_name _account, uint8_t _role);
+
+    // @abi action
+    void remcommember(uint64_t _committee_id, account_name _account);
 
     // @abi action
     void transfer(account_name from, account_name to, asset quantity, string memo);
 
+    struct payout {
+      account_name      to;
+      asset             quantity;
+
+      EOSLIB_SERIALIZE (payout, (to)(quantity));
+    };
+
+    // @abi action
+    void transfermany(account_name from, vector<payout> payouts, string memo, bool notify);
+
 
   private:
 
+#ifdef EDNADAC_NATIVE
+    friend struct native_bench;                                                 // the host benchmark seeds rows no action writes yet, e.g. researches
+#endif
+
+#ifdef EDNADAC_METRICS
+    enum metered_table { MT_MEMBERS, MT_PROPOSALS, MT_VOTES, MT_ACCOUNTS, MT_STAT, MT_NEWSS, MT_COUNT };
+
+    struct table_meter {
+      uint32_t          reads = 0;
+      uint32_t          writes = 0;
+      uint32_t          emplaces = 0;
+      uint32_t          erases = 0;
+      uint64_t          bytes = 0;                                              // serialized row bytes written
+    };
+
+    table_meter         _meters[MT_COUNT];
+
+    void dump_meters() const;
+#endif
+
     // membership statuses
     const uint8_t   MEM_MEMBER = 1;
     const uint8_t   MEM_IN_QUEUE = 2;
@@ -75,21 +209,32 @@ class ednadac : public contract
     const uint8_t   MEM_SUSPENDED = 9;
     const uint8_t   MEM_BANNED = 10;
     const uint8_t   MEM_QUIT = 11;
-
-    // member record update types
-    const uint8_t   MEM_STATUS = 1;
-    const uint8_t   CUST_STATUS = 2;
-    const uint8_t   TELE_USER = 3;
-    const uint8_t   PROP_COUNT = 4;
-    const uint8_t   VOTE_COUNT = 5;
-    const uint8_t   COMP_SERVICE = 6;
-    const uint8_t   COMP_RESEARCH = 7;
-    const uint8_t   MEM_BALANCE = 8;
-    const uint8_t   MEM_BIO = 9;
-    const uint8_t   MEM_PHOTO = 10;
-    const uint8_t   MEM_VIDEO = 11;
-    const uint8_t   MEM_TRAITS = 12;
-    const uint8_t   MEM_GEN_DATA = 13;
+    const uint8_t   MEM_LAPSED = 12;                                            // renewal date passed - set by memcheck
+
+    // member record update types - static so they can be used as switch labels
+    static const uint8_t   MEM_STATUS = 1;
+    static const uint8_t   CUST_STATUS = 2;
+    static const uint8_t   TELE_USER = 3;
+    static const uint8_t   PROP_COUNT = 4;
+    static const uint8_t   VOTE_COUNT = 5;
+    static const uint8_t   COMP_SERVICE = 6;
+    static const uint8_t   COMP_RESEARCH = 7;
+    static const uint8_t   MEM_BALANCE = 8;
+    static const uint8_t   MEM_BIO = 9;
+    static const uint8_t   MEM_PHOTO = 10;
+    static const uint8_t   MEM_VIDEO = 11;
+    static const uint8_t   MEM_TRAITS = 12;
+    static const uint8_t   MEM_GEN_DATA = 13;
+
+    // proposal types
+    const uint8_t   GENERAL_PROPOSAL = 1;
+    const uint8_t   CUSTODIAL_MATTER = 2;
+    const uint8_t   REFERENDUM = 3;
+    const uint8_t   ELECTION_BALLOT = 4;                                        // only used to key custodian election votes
+
+    // vote values
+    const uint8_t   VOTE_NO = 0;
+    const uint8_t   VOTE_YES = 1;
 
     // proposal statuses
     const uint8_t   GEN_NEW = 1;
@@ -107,6 +252,20 @@ class ednadac : public contract
     const uint8_t   IMPEACH_NEW = 13;
     const uint8_t   IMPEACH_ENDED = 14;
 
+    // proposal sweeping
+    const uint64_t  PROP_NO_ACTION = 0xFFFFFFFFFFFFFFFF;                        // deadline of a closed proposal - sorts after every open one
+    const uint32_t  MAX_SWEEP_ROWS = 100;                                       // most rows a single sweep may touch
+    const uint32_t  MAX_BATCH_ROWS = 100;                                       // most entries a single batch action may carry
+    const uint32_t  MAX_NEWS_CAPACITY = 4096;                                   // upper bound on news ring slots
+    const uint8_t   MAX_REF_SHARDS = 64;                                        // upper bound on referendum tally rows
+    const uint64_t  REWARD_SCALE = 1000000000000;                              // fixed point scale of config.reward_per_member
+
+    // scheduled job types
+    const uint8_t   JOB_PROP_CHECK = 1;                                         // target_id = prop_id
+    const uint8_t   JOB_MEM_CHECK = 2;                                          // recurring membership expiry sweep
+    const uint32_t  MEM_CHECK_INTERVAL = (60 * 60 * 24);
+    const uint8_t   JOB_ELECTION_CHECK = 3;                                     // target_id = election_id
+
     // service propsal statuses
     const uint8_t   SERV_NEW = 1;
     const uint8_t   SERV_DENIED = 2;
@@ -130,12 +289,19 @@ class ednadac : public contract
     const uint8_t   	RESEARCH_PAID = 8;
     const uint8_t     RESEARCH_PMT_DISTRIBUTED = 9;
 
+    // research committee roles
+    const uint8_t   COMMITTEE_CHAIR = 1;
+    const uint8_t   COMMITTEE_MEMBER = 2;
+    const uint64_t  NO_MEMBER = 0xFFFFFFFFFFFFFFFF;                             // empty member reference
+
     // election statuses
     const uint8_t   ELECT_OFF = 1;
     const uint8_t   ELECT_NOMINATING = 2;
     const uint8_t   ELECT_VOTING = 3;
     const uint8_t   ELECT_TABULATING = 4;
     const uint8_t   ELECT_HISTORY = 5;
+    const uint8_t   ELECT_DEFEATING = 6;                                        // seats filled, losing candidates marked in batches
+    const uint64_t  NO_ELECTION = 0xFFFFFFFFFFFFFFFF;                           // config.last_election_id before the first election
 
     // custodian statuses
     const uint8_t   CUSTO_NONE = 1;
@@ -159,12 +325,13 @@ class ednadac : public contract
 // TABLE STRUCTURES
 
   // @abi table members i64
+  // hot row - fixed size, touched by every vote, proposal and balance update
   struct member{
       uint64_t          	member_id;
       account_name      	account;
       uint8_t           	member_status;                                        // see possible statuses above
+      uint8_t             lapsed_from;                                          // status to restore when a MEM_LAPSED member renews
       uint8_t             custodial_status;                                     // see possible statuses above
-      string            	telegram_user;
       uint32_t            proposal_count;
       uint32_t            vote_count;
       uint32_t            completed_service_count;
@@ -173,35 +340,57 @@ class ednadac : public contract
       asset               research_value_earned;
       asset               total_value_earned;
       asset               member_balance;
-      string              ipfs_member_bio;
-      string              ipfs_member_photo;
-      string              ipfs_member_video;
-      string              ipfs_traits_data;
-      string              ipfs_gen_data;
+      uint128_t           reward_checkpoint;                                    // config.reward_per_member when rewards were last settled
       uint32_t          	joined_date;
       uint32_t            renewal_date;
+
+  // members ordered by status, then renewal date - lapsed and lifetime members sit outside the active status ranges
+  static uint64_t status_renewal_key(uint8_t status, uint32_t renewal) { return ((uint64_t)status << 32) | renewal; }
+
+  uint64_t      primary_key() const { return member_id; }
+  uint64_t      by_account() const { return account; }
+  uint64_t      by_renewal() const { return status_renewal_key(member_status, renewal_date); }
+
+  EOSLIB_SERIALIZE (member, (member_id)(account)(member_status)(lapsed_from)(custodial_status)(proposal_count)(vote_count)
+  (completed_service_count)(research_opt_in_count)(completed_service_value)(research_value_earned)(total_value_earned)
+  (member_balance)(reward_checkpoint)(joined_date)(renewal_date));
+};
+typedef eosio::multi_index<N(members), member,
+    indexed_by<N(byaccount),const_mem_fun<member, uint64_t, &member::by_account>>,
+    indexed_by<N(byrenewal),const_mem_fun<member, uint64_t, &member::by_renewal>>>member_table;
+
+
+  // @abi table memprofiles i64
+  // cold row - variable length profile data, only touched when the member edits their profile
+  struct memprofile{
+      uint64_t          	member_id;                                            // same key as the members row
+      string            	telegram_user;
+      ipfshash            ipfs_member_bio;
+      ipfshash            ipfs_member_photo;
+      ipfshash            ipfs_member_video;
+      ipfshash            ipfs_traits_data;
+      ipfshash            ipfs_gen_data;
       uint64_t            spare1;
       uint64_t            spare2;
       string              spare3;
       asset               spare4;
 
-
   uint64_t      primary_key() const { return member_id; }
 
-  EOSLIB_SERIALIZE (member, (member_id)(account)(member_status)(custodial_status)(telegram_user)(proposal_count)
-  (vote_count)(completed_service_count)(completed_service_value)(research_opt_in_count)(research_value_earned)(total_value_earned)(member_balance)
-  (ipfs_traits_data)(ipfs_gen_data)(joined_date)(spare1)(spare2)(spare3)(spare4));
+  EOSLIB_SERIALIZE (memprofile, (member_id)(telegram_user)(ipfs_member_bio)(ipfs_member_photo)(ipfs_member_video)
+  (ipfs_traits_data)(ipfs_gen_data)(spare1)(spare2)(spare3)(spare4));
 };
-typedef eosio::multi_index<N(members), member> member_table;
+typedef eosio::multi_index<N(memprofiles), memprofile> memprofile_table;
 
 
   // @abi table propsals i64
   struct proposal {
     uint64_t          prop_id;
     uint64_t          sponsor_id;                                               //points to member_id
+    uint8_t           prop_type;                                                //points to const proposal types
     uint8_t           prop_status;                                              //points to const propsal statuses
     string            prop_title;
-    string            prop_ipfs_text;                                           //ipfs storage hash string
+    ipfshash          prop_ipfs_text;                                           //ipfs storage hash
     uint32_t          prop_gen_total_votes;
     uint32_t          prop_gen_yes_count;
     uint32_t          prop_gen_no_count;
@@ -211,22 +400,21 @@ typedef eosio::multi_index<N(members), member> member_table;
     uint32_t          prop_ref_total_votes;
     uint32_t          prop_ref_yes_count;
     uint32_t          prop_ref_no_count;
-    uint64_t          prop_next_action_date;
+    uint64_t          prop_next_action_date;                                    //PROP_NO_ACTION once the proposal is closed
 
     uint64_t      primary_key() const { return prop_id; }
     uint64_t      by_status() const {return prop_status;}
+    uint64_t      by_deadline() const {return prop_next_action_date;}
 
-    EOSLIB_SERIALIZE (proposal, (prop_id)(sponsor_id)(prop_status)(prop_title)(prop_ipfs_text)
+    EOSLIB_SERIALIZE (proposal, (prop_id)(sponsor_id)(prop_type)(prop_status)(prop_title)(prop_ipfs_text)
     (prop_gen_total_votes)(prop_gen_yes_count)(prop_gen_no_count)
     (prop_cus_total_votes)(prop_cus_yes_count)(prop_cus_no_count)
-    ()()()()());
+    (prop_ref_total_votes)(prop_ref_yes_count)(prop_ref_no_count)(prop_next_action_date));
   };
 
 typedef eosio::multi_index<N(proposals), proposal,
-    indexed_by<N(status),const_mem_fun<proposal, uint64_t, &proposal::by_status>>>proposal_table;
-
-    //local instances of the props table multi-index
-    proposal_table _props
+    indexed_by<N(status),const_mem_fun<proposal, uint64_t, &proposal::by_status>>,
+    indexed_by<N(deadline),const_mem_fun<proposal, uint64_t, &proposal::by_deadline>>>proposal_table;
 
   // @abi action
   void propbytype(uint8_t _type);
@@ -236,7 +424,7 @@ typedef eosio::multi_index<N(proposals), proposal,
     uint64_t          	service_id;
     uint64_t          	member_id;
     uint8_t            	service_status;
-    string            	ipfs_service_descr;
+    ipfshash          	ipfs_service_descr;
     asset              	service_cost;
     uint64_t           	start_date;
     uint64_t          	projected_end_date;
@@ -266,11 +454,11 @@ typedef eosio::multi_index<N(services), service> service_table;
     uint64_t  		number_genomes_sought;
     uint64_t			number_of_opt_ins;
     uint8_t  			genome_type;
-    string  			ipfs_hash_traits_sought;
-    string			  ipfs_fund_source_disclos;
-    string 			  ipfs_research_purpose;
-    string  			ipfs_pub_list;
-    string  			ipfs_notes;
+    ipfshash 			ipfs_hash_traits_sought;
+    ipfshash		  ipfs_fund_source_disclos;
+    ipfshash		  ipfs_research_purpose;
+    ipfshash 			ipfs_pub_list;
+    ipfshash 			ipfs_notes;
     asset  			  proposed_payment;
     asset				  surety_bond_posted;
     uint8_t  			profit_sharing_offered;
@@ -278,128 +466,231 @@ typedef eosio::multi_index<N(services), service> service_table;
     uint8_t  			agree_intended_use;
     uint8_t  			agree_edna_constitution;
     uint8_t  			agree_eos_constitution;
+    asset  			  payout_share;                                             // per member payment, fixed by the first distribute call
+    asset  			  payout_funds;                                             // what fundresearch paid in and distribute has yet to pay out
+    uint64_t  		payout_cursor;                                            // next member_id to pay in the opt-in cohort
 
     uint64_t      primary_key() const { return research_id; }
     EOSLIB_SERIALIZE (research, (research_id)(edna_sponsor_id)(project_title)(research_status)(company_entity)(contact)(email)(telephone)(website)
     (number_genomes_sought)(number_of_opt_ins)(genome_type)(ipfs_hash_traits_sought)(ipfs_fund_source_disclos)(ipfs_research_purpose)
     (ipfs_pub_list)(ipfs_notes)(proposed_payment)(surety_bond_posted)(profit_sharing_offered)
-    (agree_terms_of_service)(agree_intended_use)(agree_edna_constitution)(agree_eos_constitution));
+    (agree_terms_of_service)(agree_intended_use)(agree_edna_constitution)(agree_eos_constitution)(payout_share)(payout_funds)(payout_cursor));
   };
 
   typedef eosio::multi_index<N(researches), research> research_table;
 
-  // @abi table services i64
+  // @abi table rcommittees i64
   struct rcommittee {
       uint64_t			committee_id;
       uint64_t			research_id;
-      uint64_t			chairman_id;
-      uint64_t			member1_id;
-      uint64_t			member2_id;
-      uint64_t			member3_id;
-      uint64_t			member4_id;
-      uint64_t			member5_id;
-      uint64_t			member6_id;
-      uint64_t			member7_id;
-      uint64_t			member8_id;
-      uint64_t			member9_id;
-      uint64_t			member10_id;
-      uint64_t			member11_id;
+      uint64_t			chairman_id;                                              // NO_MEMBER until a chair is seated
+      uint32_t			member_count;                                             // seats filled, chair included - at most config.committee_size
 
     uint64_t      primary_key() const { return committee_id; }
-    EOSLIB_SERIALIZE (rcommittee, (committee_id)(research_id)(chairman_id)(member1_id)(member2_id)(member3_id)(member4_id)(member5_id)
-    (member6_id)(member7_id)(member8_id)(member9_id)(member10_id)(member11_id));
+    EOSLIB_SERIALIZE (rcommittee, (committee_id)(research_id)(chairman_id)(member_count));
 
 };
 typedef eosio::multi_index<N(rcommittees), rcommittee> rcommittee_table;
 
-  // @abi table services i64
+  // @abi table rcommembers i64
+  struct rcommember {
+      uint64_t			rcommember_id;
+      uint64_t			committee_id;
+      uint64_t			member_id;
+      uint8_t			  role;                                                     // see committee roles above
+
+    uint64_t      primary_key() const { return rcommember_id; }
+    uint128_t     by_committee() const { return ((uint128_t)committee_id << 64) | member_id; }
+    uint128_t     by_member() const { return ((uint128_t)member_id << 64) | committee_id; }
+    EOSLIB_SERIALIZE (rcommember, (rcommember_id)(committee_id)(member_id)(role));
+
+};
+typedef eosio::multi_index<N(rcommembers), rcommember,
+    indexed_by<N(bycommittee),const_mem_fun<rcommember, uint128_t, &rcommember::by_committee>>,
+    indexed_by<N(bymember),const_mem_fun<rcommember, uint128_t, &rcommember::by_member>>>rcommember_table;
+
+  // @abi table resmemxrefs i64
   struct resmemxref {
+      uint64_t			xref_id;
       uint64_t			research_id;
       uint64_t			member_id;
 
-    uint64_t      primary_key() const { return research_id; }
-    EOSLIB_SERIALIZE (resmemxref, (research_id)(member_id));
+    uint64_t      primary_key() const { return xref_id; }
+    uint128_t     by_research() const { return ((uint128_t)research_id << 64) | member_id; }
+    uint128_t     by_member() const { return ((uint128_t)member_id << 64) | research_id; }
+    EOSLIB_SERIALIZE (resmemxref, (xref_id)(research_id)(member_id));
 };
 
-typedef eosio::multi_index<N(resmemxrefs), resmemxref> resmemxref_table;
+typedef eosio::multi_index<N(resmemxrefs), resmemxref,
+    indexed_by<N(byresearch),const_mem_fun<resmemxref, uint128_t, &resmemxref::by_research>>,
+    indexed_by<N(bymember),const_mem_fun<resmemxref, uint128_t, &resmemxref::by_member>>>resmemxref_table;
 
-// @abi table services i64
+// @abi table elections i64
 struct election{
   uint64_t            election_id;
   uint8_t             election_status;
   uint32_t          	next_action_date;
+  uint64_t            defeat_cursor;                                            // next member_id to look at while ELECT_DEFEATING
 
 uint64_t      primary_key() const { return election_id; }
-EOSLIB_SERIALIZE (election, (election_id)(election_status)(next_action_date));
+EOSLIB_SERIALIZE (election, (election_id)(election_status)(next_action_date)(defeat_cursor));
 };
 
 typedef eosio::multi_index<N(elections), election> election_table;
 
 
-// @abi table services i64
+// @abi table elemembxrefs i64
+// one row per candidate - votes is kept as ballots are cast so tabulating is a walk down byvotes
 struct elemembxref{
   uint64_t            elemembxref_id;
   uint64_t            election_id;
-  uint64_t            memeber_id;
+  uint64_t            member_id;
   uint32_t            votes;
   uint8_t             elected;
 
 uint64_t  primary_key() const { return elemembxref_id; }
-EOSLIB_SERIALIZE (elemembxref, (elemembxref_id)(election_id)(memeber_id)(votes)(elected));
+uint128_t by_votes() const { return ((uint128_t)election_id << 64) | votes; }
+uint128_t by_candidate() const { return ((uint128_t)election_id << 64) | member_id; }
+uint128_t by_member() const { return ((uint128_t)member_id << 64) | election_id; }
+EOSLIB_SERIALIZE (elemembxref, (elemembxref_id)(election_id)(member_id)(votes)(elected));
 };
 
-typedef eosio::multi_index<N(elemembxrefs), elemembxref> elemembxref_table;
+typedef eosio::multi_index<N(elemembxrefs), elemembxref,
+    indexed_by<N(byvotes),const_mem_fun<elemembxref, uint128_t, &elemembxref::by_votes>>,
+    indexed_by<N(bycandidate),const_mem_fun<elemembxref, uint128_t, &elemembxref::by_candidate>>,
+    indexed_by<N(bymember),const_mem_fun<elemembxref, uint128_t, &elemembxref::by_member>>>elemembxref_table;
 
-  // @abi table services i64
+  // @abi table votes i64
 struct vote {
   uint64_t        vote_id;
-  uint64_t        elect_id;
-  uint64_t        prop_id;
-  uint8_t         prop_type;
+  uint64_t        elect_id;                                                     // candidate elemembxref_id on election ballots
+  uint64_t        prop_id;                                                      // election_id on election ballots
+  uint8_t         prop_type;                                                    // kind of vote - general, custodial, referendum or election ballot
   uint64_t        member_id;
   uint8_t         how_vote;
 
+  // the prop type lives in the top byte so each voting round on a proposal gets its own key range
+  static uint64_t   prop_key(uint8_t type, uint64_t id) { return ((uint64_t)type << 56) | id; }
+  static uint128_t  prop_member_key(uint8_t type, uint64_t id, uint64_t member) { return ((uint128_t)prop_key(type, id) << 64) | member; }
+
   uint64_t  primary_key() const { return vote_id; }
+  uint64_t  by_prop() const { return prop_key(prop_type, prop_id); }
+  uint64_t  by_member() const { return member_id; }
+  uint128_t by_prop_member() const { return prop_member_key(prop_type, prop_id, member_id); }
 
   EOSLIB_SERIALIZE (vote, (vote_id)(elect_id)(prop_id)(prop_type)(member_id)(how_vote));
   };
 
-typedef eosio::multi_index<N(votes), vote> vote_table;
+typedef eosio::multi_index<N(votes), vote,
+    indexed_by<N(byprop),const_mem_fun<vote, uint64_t, &vote::by_prop>>,
+    indexed_by<N(bymember),const_mem_fun<vote, uint64_t, &vote::by_member>>,
+    indexed_by<N(propmember),const_mem_fun<vote, uint128_t, &vote::by_prop_member>>>vote_table;
 
-// @abi table services i64
+// @abi table newss i64
 struct news {
-uint64_t        news_id;
+uint64_t        news_id;                                                        // ring slot - see config.news_capacity
 uint8_t         news_type;
+uint64_t        member_id;                                                      // member the item is about - removed with them on archive
+uint64_t        news_ref;                                                       // id of the proposal, election etc. the item refers to
 string          news_text;
-uint32_t        news_ttl;
+uint32_t        news_ttl;                                                       // time the item expires and may be pruned
 
 uint64_t  primary_key() const { return news_id; }
+uint64_t  by_member() const { return member_id; }
+uint64_t  by_expiry() const { return news_ttl; }
+
+EOSLIB_SERIALIZE (news, (news_id)(news_type)(member_id)(news_ref)(news_text)(news_ttl));
+};
+
+typedef eosio::multi_index<N(newss), news,
+    indexed_by<N(bymember),const_mem_fun<news, uint64_t, &news::by_member>>,
+    indexed_by<N(byexpiry),const_mem_fun<news, uint64_t, &news::by_expiry>>>news_table;
+
+// @abi table memarchives i64
+// what is kept of a member once archivemem has released their rows
+struct memarchive {
+uint64_t        member_id;
+account_name    account;
+uint8_t         member_status;
+uint32_t        joined_date;
+uint32_t        archived_date;
+asset           total_value_earned;
+asset           member_balance;
+
+uint64_t  primary_key() const { return member_id; }
+uint64_t  by_account() const { return account; }
+
+EOSLIB_SERIALIZE (memarchive, (member_id)(account)(member_status)(joined_date)(archived_date)(total_value_earned)(member_balance));
+};
+
+typedef eosio::multi_index<N(memarchives), memarchive,
+    indexed_by<N(byaccount),const_mem_fun<memarchive, uint64_t, &memarchive::by_account>>>memarchive_table;
+
+// @abi table jobs i64
+struct job {
+uint64_t        job_id;
+uint64_t        due_time;
+uint8_t         job_type;
+uint64_t        target_id;
 
-EOSLIB_SERIALIZE (news, (news_id)(news_type)(news_text)(news_ttl));
+uint64_t  primary_key() const { return job_id; }
+uint64_t  by_due() const { return due_time; }
+uint128_t by_target() const { return ((uint128_t)job_type << 64) | target_id; }
+
+EOSLIB_SERIALIZE (job, (job_id)(due_time)(job_type)(target_id));
 };
 
-typedef eosio::multi_index<N(newss), news> news_table;
+typedef eosio::multi_index<N(jobs), job,
+    indexed_by<N(due),const_mem_fun<job, uint64_t, &job::by_due>>,
+    indexed_by<N(bytarget),const_mem_fun<job, uint128_t, &job::by_target>>>job_table;
+
+// @abi table reftallys i64
+// scoped by prop_id - referendum votes land on shard member_id % ref_shards so voters don't all rewrite the proposal row
+struct reftally {
+uint64_t        shard;
+uint32_t        yes_count;
+uint32_t        no_count;
 
+uint64_t  primary_key() const { return shard; }
+
+EOSLIB_SERIALIZE (reftally, (shard)(yes_count)(no_count));
+};
 
+typedef eosio::multi_index<N(reftallys), reftally> reftally_table;
 
 
+
+
+    // @abi table config i64
     struct config {
       uint64_t      config_id;
-      uint64_t      member_count;                                               // current active membership
+      uint64_t      member_count = 0;                                           // current active membership
+      uint64_t      next_member_id = 0;                                         // ids are never reused once a member is archived
       uint8_t       new_members_allowed = 1;                                    // non-zero = taking on new members
       uint32_t      mem_ttl = (60 * 60 * 24 * 365);                             // duration of membership - must renew after (-1 to disable renewals)
       uint64_t      proposal_escalation = 40;                                   // % of members that must vote on a general proposal (+ or -) to auto-escalate to custodian action
       uint32_t      mem_vote_ttl = (60 * 60 * 24 * 7);                          // time before a member proposal is removed or converted to a custodial vote
       uint32_t      custodian_vote_ttl = (60 * 60 * 24 * 2);                    // time betwwen stalled custodial votes
       uint64_t      referendum_passage = 51;                                    // % of membership that must approve or defeat a referendum
+      uint64_t      escalation_votes = 1;                                       // proposal_escalation % of member_count in votes - see update_thresholds
+      uint64_t      referendum_votes = 1;                                       // referendum_passage % of member_count in votes - see update_thresholds
+      uint8_t       ref_shards = 16;                                            // tally rows per referendum, merged when it closes
       uint64_t      nominations_ttl = (60 * 60 * 24 * 3);                       // the 'time window' for nominations to run for custodian
       uint64_t      elections_ttl = (60 * 60 * 24 * 5);                         // the 'time window' for elections to occur
+      uint32_t      news_ttl = (60 * 60 * 24 * 14);                             // how long a news item stays in the feed
+      uint32_t      news_capacity = 512;                                        // slots in the news ring - the oldest item is overwritten when full
+      uint64_t      news_next = 0;                                              // ring write cursor - next slot is news_next % news_capacity
       uint8_t       custodian_count = 12;                                       // the number of sitting custodians
+      uint32_t      committee_size = 12;                                        // seats on a research committee, chair included
       uint8_t       custodial_majority = 9;                                     // 9 of 12 must approve or defeat a custodial vote
       uint32_t      custodian_ttl = (60 * 60 * 24 * 30);                        // time between custodial elections
       uint64_t      next_election_due;                                          // datetime of next election
-      asset         dac_funds_main;                                             // the amount of edna in the ednadactokens account
-      asset         dac_funds_approved_spend;                                   // the amount of edna in the dac "checking account"
+      uint64_t      last_election_id = 0xFFFFFFFFFFFFFFFF;                      // election that seated the current custodians - none yet
+      uint8_t       custodians_seated = 0;                                      // candidates last_election_id seated, bounds the unseat walk
+      asset         dac_funds_main = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};           // the amount of edna in the ednadactokens account
+      asset         dac_funds_approved_spend = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")}; // the amount of edna in the dac "checking account"
+      asset         dac_funds_rewards = asset{static_cast<int64_t>(0), string_to_symbol(4, "EDNA")};        // shared by rewardall, not yet paid by settle_rewards
+      uint128_t     reward_per_member = 0;                                      // running total of rewards per member, times REWARD_SCALE
       asset         mem_fee = asset{static_cast<int64_t>(1), string_to_symbol(4, "EDNA")}; // cost of membership for the mem_ttl timeframe
       account_name  mem_fund;                                                   // storage account for membership dues
       uint64_t      spare1;                                                     // placholder for future modifications
@@ -408,12 +699,29 @@ typedef eosio::multi_index<N(newss), news> news_table;
 
       uint64_t      primary_key() const { return config_id; }
 
-      EOSLIB_SERIALIZE (config, (config_id)(member_count)(new_members_allowed)(mem_fee)(mem_ttl)(nominations_ttl)(elections_ttl)
-      (proposal_escalation)(mem_vote_ttl)(custodial_majority)(referendum_passage)(custodian_ttl)(custodian_vote_ttl)(next_cust_election_due)
-      (dac_funds_main)(dac_funds_approved_spend)(mem_fund)(spare1)(spare2)(spare3));
+      EOSLIB_SERIALIZE (config, (config_id)(member_count)(next_member_id)(new_members_allowed)(mem_ttl)(proposal_escalation)(mem_vote_ttl)
+      (custodian_vote_ttl)(referendum_passage)(escalation_votes)(referendum_votes)(ref_shards)(nominations_ttl)(elections_ttl)
+      (news_ttl)(news_capacity)(news_next)(custodian_count)(committee_size)(custodial_majority)(custodian_ttl)(next_election_due)
+      (last_election_id)(custodians_seated)(dac_funds_main)(dac_funds_approved_spend)(dac_funds_rewards)(reward_per_member)(mem_fee)(mem_fund)(spare1)(spare2)(spare3));
   };
 
-  typedef eosio::multi_index<N(configs), config> config_table;
+  typedef eosio::singleton<N(config), config> config_singleton;
+
+  // per-action cache of the config singleton - read on first use, written back by the destructor if edited
+  config_singleton    _config_single;
+  config              _config;
+  bool                _config_loaded = false;
+  bool                _config_dirty = false;
+
+  const config &get_config();
+  config &edit_config();
+
+  public:
+
+    // @abi action
+    void setconfig(config _new);
+
+  private:
 
 
 
@@ -445,6 +753,33 @@ struct currencystat
 typedef eosio::multi_index<N(accounts), account> accounts;
 typedef eosio::multi_index<N(stat), currencystat> stats;
 
+void update_thresholds(config &c);
+ipfshash ipfs_decode(const string &cid);
+void check_update_auth(account_name _account, uint8_t _upd_type, uint8_t _param_i8);
+void settle_rewards(member &c);
+
+void post_news(uint8_t news_type, uint64_t member_id, uint64_t ref_id, const string &text);
+uint32_t prune_news(uint32_t max_rows);
+
+void queue_archive(account_name _account, uint64_t member_id, uint32_t delay);
+void emplace_member(member_table &m_t, account_name _account, const string &tele_user, uint32_t mem_ttl);
+
+bool extend_membership(member &c, uint32_t mem_ttl);
+uint32_t sweep_members(uint32_t max_rows);
+
+uint64_t advance_election(uint64_t election_id);
+void seat_custodians(uint64_t election_id);
+bool defeat_candidates(uint64_t election_id, uint64_t &cursor, uint32_t max_rows);
+
+uint32_t sweep_proposals(uint32_t max_rows);
+void close_referendum(proposal &p, const config &c);
+void advance_proposal(proposal &p, const config &c);
+
+void schedule_job(uint8_t job_type, uint64_t target_id, uint64_t due_time);
+void retime_job(uint8_t job_type, uint64_t target_id, uint64_t due_time);
+void run_job(const job &j, uint64_t &next_due);
+void arm_alarm();
+
 void sub_balance(account_name owner, asset value);
 void add_balance(account_name owner, asset value, account_name ram_payer);
 
@@ -475,5 +810,8 @@ const auto &ac = accountstable.get(sym);
 return ac.balance;
 }
 
-EOSIO_ABI( ednadac,(addmember)(deletemember)(renewmember)(updatemember)(newgenprop)
-(votegenprop)(transfer))
+// a host build (-DEDNADAC_NATIVE) drives the actions directly and supplies its own apply()
+#ifndef EDNADAC_NATIVE
+EOSIO_ABI( ednadac,(addmember)(addmembers)(deletemember)(renewmember)(renewmembers)(updatemember)(updmemfields)(archivemem)(memcheck)(newgenprop)
+(votegenprop)(custvote)(refvote)(genpropcheck)(globalalarms)(setmemfund)(setconfig)(fundrewards)(rewardall)(claim)(optin)(optout)(fundresearch)(distribute)(newelection)(nominate)(votecust)(tabulate)(newcommittee)(addcommember)(remcommember)(transfer)(transfermany))
+#endif
@@ -0,0 +1,470 @@
+/**
+ *  @file
+ *  host-side benchmark driver for ednadac
+ *
+ *  Replays a synthetic DAC against the in-memory eosiolib: token setup, member enrollment, general
+ *  proposals and member votes, a funded reward and claims, then lets the clock run past the voting
+ *  windows so globalalarms sweeps every proposal. A custodian election, escalated proposals through
+ *  custodial votes and referenda, research opt-ins and payouts and archived members follow. Reports per-action wall time, heap allocations, rows and packed bytes
+ *  written, and table lookups. A build with -DEDNADAC_METRICS also writes each action's table
+ *  meters as one JSON line to the --meters file.
+ *
+ *  bench [--members N] [--proposals N] [--votes N] [--seed N] [--json FILE] [--meters FILE]
+ */
+
+#include "mock.hpp"
+#include "../ednadac.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace eosio;
+
+/*******************************************************************************
+ * Allocation counting *********************************************************
+ *******************************************************************************/
+
+static uint64_t g_allocs = 0;
+static uint64_t g_alloc_bytes = 0;
+
+// kept out of line so gcc does not see malloc and free through the inlined operators and pair them up wrongly
+__attribute__((noinline)) void* operator new( size_t size ) {
+   g_allocs++;
+   g_alloc_bytes += size;
+   if( void* p = std::malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+
+void* operator new[]( size_t size ) { return operator new( size ); }
+__attribute__((noinline)) void operator delete( void* p ) noexcept { std::free( p ); }
+void  operator delete[]( void* p ) noexcept { operator delete( p ); }
+void  operator delete( void* p, size_t ) noexcept { operator delete( p ); }
+void  operator delete[]( void* p, size_t ) noexcept { operator delete( p ); }
+
+/*******************************************************************************
+ * Per-action accounting *******************************************************
+ *******************************************************************************/
+
+struct action_stats {
+   uint64_t calls = 0;
+   uint64_t failures = 0;
+   uint64_t total_ns = 0;
+   uint64_t max_ns = 0;
+   uint64_t allocs = 0;
+   uint64_t alloc_bytes = 0;
+   uint64_t rows_written = 0;
+   uint64_t bytes_written = 0;
+   uint64_t rows_erased = 0;
+   uint64_t db_reads = 0;
+};
+
+static std::map<std::string, action_stats> g_report;
+static std::ofstream*                      g_meters = nullptr;
+static const account_name                  g_self = N(ednadac);
+
+// runs one action body and charges everything it did, including inline actions it sent, to name
+template<typename Body>
+static bool timed( const std::string& name, Body&& body ) {
+   auto& s = g_report[name];
+   auto before = mock::stats();
+   uint64_t allocs = g_allocs, alloc_bytes = g_alloc_bytes;
+
+   std::ostringstream console;
+   if( g_meters )
+      mock::set_console( &console );
+
+   bool ok = true;
+   auto start = std::chrono::steady_clock::now();
+   try {
+      body();
+      mock::run_inline();
+   } catch( const mock::assert_error& e ) {
+      ok = false;
+      if( s.failures++ < 3 )
+         std::cerr << name << " failed: " << e.what() << "\n";
+   }
+   uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+
+   const auto& after = mock::stats();
+   s.calls++;
+   s.total_ns += ns;
+   s.max_ns = std::max( s.max_ns, ns );
+   s.allocs += g_allocs - allocs;
+   s.alloc_bytes += g_alloc_bytes - alloc_bytes;
+   s.rows_written += after.rows_written - before.rows_written;
+   s.bytes_written += after.bytes_written - before.bytes_written;
+   s.rows_erased += after.rows_erased - before.rows_erased;
+   s.db_reads += after.db_reads - before.db_reads;
+
+   if( g_meters ) {
+      mock::set_console( nullptr );
+      std::string out = console.str();
+      while( !out.empty() && out.back() == '\n' )
+         out.pop_back();
+      if( !out.empty() )
+         *g_meters << "{\"action\":\"" << name << "\",\"meters\":" << out << "}\n";
+   }
+   return ok;
+}
+
+// pushes an action the way a transaction would - a fresh contract object under the given authority
+template<typename Call>
+static bool push( const std::string& name, std::vector<account_name> auths, Call&& call ) {
+   mock::set_auth( std::move(auths) );
+   return timed( name, [&]() {
+      ednadac c( g_self );
+      call( c );
+   });
+}
+
+// deferred transactions the contract sends to itself
+static void dispatch( const action& act ) {
+   std::string name = mock::name_to_string( act.name );
+   timed( name, [&]() {
+      ednadac c( act.account );
+      if( act.name == N(globalalarms) ) {
+         c.globalalarms();
+      }
+      else if( act.name == N(archivemem) ) {
+         c.archivemem( std::get<0>( std::any_cast<std::tuple<account_name>>( act.data ) ) );
+      }
+      else {
+         eosio_assert( false, "bench has no dispatch for this deferred action" );
+      }
+   });
+}
+
+/*******************************************************************************
+ * Contract state the actions cannot reach *************************************
+ *******************************************************************************/
+
+// reads and seeds private tables outside any timed action - researches have no intake action yet
+struct native_bench {
+   static auto config() {
+      ednadac c( g_self );
+      return c.get_config();
+   }
+
+   // a member voting threshold low enough that a few thousand votes escalate a proposal
+   static void lower_escalation( uint64_t percent ) {
+      mock::set_auth( { g_self } );
+      ednadac c( g_self );
+      auto cfg = c.get_config();
+      cfg.proposal_escalation = percent;
+      c.setconfig( cfg );
+   }
+
+   static std::vector<account_name> sitting_custodians() {
+      std::vector<account_name> sitting;
+      ednadac c( g_self );
+      ednadac::member_table m_t( g_self, g_self );
+      for( const auto& m : m_t )
+         if( m.custodial_status == c.CUSTO_SITTING )
+            sitting.push_back( m.account );
+      return sitting;
+   }
+
+   static uint64_t next_proposal_id() {
+      ednadac::proposal_table p_t( g_self, g_self );
+      return p_t.available_primary_key();
+   }
+
+   static void quit( ednadac& c, account_name account ) {
+      c.updatemember( account, ednadac::MEM_STATUS, c.MEM_QUIT, 0, 0, "", asset( 0, c.get_config().mem_fee.symbol ) );
+   }
+
+   static void add_research( uint64_t research_id, uint64_t genomes, asset payment ) {
+      ednadac c( g_self );
+      ednadac::research_table r_t( g_self, g_self );
+      r_t.emplace( g_self, [&]( auto& r ) {
+         r.research_id = research_id;
+         r.edna_sponsor_id = 0;
+         r.research_status = c.RESEARCH_ACCEPTING_OPT_IN;
+         r.number_genomes_sought = genomes;
+         r.number_of_opt_ins = 0;
+         r.genome_type = 0;
+         r.proposed_payment = payment;
+         r.surety_bond_posted = asset( 0, payment.symbol );
+         r.profit_sharing_offered = 0;
+         r.agree_terms_of_service = r.agree_intended_use = r.agree_edna_constitution = r.agree_eos_constitution = 1;
+         r.payout_share = asset( 0, payment.symbol );
+         r.payout_funds = asset( 0, payment.symbol );
+         r.payout_cursor = 0;
+      });
+   }
+
+   static void complete_research( uint64_t research_id ) {
+      ednadac c( g_self );
+      ednadac::research_table r_t( g_self, g_self );
+      r_t.modify( r_t.find( research_id ), 0, [&]( auto& r ) { r.research_status = c.RESEARCH_COMPLETE; } );
+   }
+
+   static bool research_paid( uint64_t research_id ) {
+      ednadac c( g_self );
+      ednadac::research_table r_t( g_self, g_self );
+      return r_t.get( research_id ).research_status == c.RESEARCH_PAID;
+   }
+};
+
+/*******************************************************************************
+ * Workload ********************************************************************
+ *******************************************************************************/
+
+// moves the clock on, running every deferred transaction that falls due on the way
+static void advance( uint32_t seconds, uint64_t& failures ) {
+   uint32_t due;
+   uint32_t horizon = mock::get_time() + seconds;
+   while( mock::next_deferred( due ) && due <= horizon ) {
+      mock::set_time( std::max( due, mock::get_time() ) );
+      mock::run_deferred( failures );
+   }
+   mock::set_time( horizon );
+}
+
+static account_name member_name( uint64_t i ) {
+   static const char* digits = "abcdefghijklmnopqrstuvwxyz12345";
+   std::string s = "mbr";
+   do {
+      s += digits[i % 31];
+      i /= 31;
+   } while( i );
+   return mock::name_from_string( s );
+}
+
+static uint64_t arg_value( int argc, char** argv, const char* flag, uint64_t def ) {
+   for( int i = 1; i + 1 < argc; ++i )
+      if( std::strcmp( argv[i], flag ) == 0 )
+         return std::strtoull( argv[i + 1], nullptr, 10 );
+   return def;
+}
+
+static const char* arg_string( int argc, char** argv, const char* flag ) {
+   for( int i = 1; i + 1 < argc; ++i )
+      if( std::strcmp( argv[i], flag ) == 0 )
+         return argv[i + 1];
+   return nullptr;
+}
+
+/*
+*   Elections, custodial and referendum voting, archiving and research payouts on top of the member
+*   workload - run once the member proposals have closed, with the clock well inside everyone's membership
+*/
+static void governance( const std::vector<account_name>& accounts, std::mt19937_64& rng, uint64_t votes, uint64_t& failures ) {
+   const uint64_t members = accounts.size();
+   const symbol_type edna = string_to_symbol( 4, "EDNA" );
+   const auto cfg = native_bench::config();
+
+   // the first custodian election - a tenth of the members stand, at most 1000, and every member casts a ballot
+   const uint64_t candidates = std::min<uint64_t>( members / 10, 1000 );
+   push( "newelection", { g_self }, [&]( ednadac& c ) { c.newelection(); } );
+   for( uint64_t i = 0; i < candidates; ++i )
+      push( "nominate", { accounts[i] }, [&]( ednadac& c ) { c.nominate( accounts[i], 0 ); } );
+   advance( cfg.nominations_ttl + 60, failures );
+
+   for( uint64_t i = 0; i < members; ++i ) {
+      account_name choice = accounts[ rng() % candidates ];
+      push( "votecust", { accounts[i] }, [&]( ednadac& c ) { c.votecust( accounts[i], 0, choice ); } );
+   }
+   advance( cfg.elections_ttl + 60, failures );                                 // seating, then the losers in batches
+   const auto custodians = native_bench::sitting_custodians();
+
+   // escalate proposals with member votes and hand them to the custodians - even ones pass, odd ones stall into referenda
+   native_bench::lower_escalation( 1 );
+   const uint64_t target = native_bench::config().escalation_votes;
+   const uint64_t escalated = 10;
+   const uint64_t first = native_bench::next_proposal_id();
+   for( uint64_t k = 0; k < escalated; ++k ) {
+      push( "newgenprop", { accounts[k] }, [&]( ednadac& c ) { c.newgenprop( accounts[k], "escalated", "" ); } );
+      for( uint64_t j = 0; j < target; ++j ) {
+         account_name voter = accounts[ (k * target + j) % members ];
+         push( "votegenprop", { voter }, [&]( ednadac& c ) { c.votegenprop( voter, first + k, 1 ); } );
+      }
+   }
+   advance( cfg.custodian_vote_ttl + 60, failures );
+
+   for( uint64_t k = 0; k < escalated; ++k ) {
+      for( size_t i = 0; i < custodians.size(); ++i ) {
+         if( k % 2 == 0 && i == cfg.custodial_majority )                       // decided - the rest would find it closed
+            break;
+         uint8_t how = (k % 2 == 0 || i < custodians.size() / 2) ? 1 : 0;
+         push( "custvote", { custodians[i] }, [&]( ednadac& c ) { c.custvote( custodians[i], first + k, how ); } );
+      }
+   }
+   advance( 4 * cfg.custodian_vote_ttl + 60, failures );                        // three stalls, then the referendum opens
+
+   for( uint64_t i = 0; i < std::min( votes, members ); ++i ) {
+      account_name voter = accounts[ rng() % members ];
+      uint64_t prop_id = first + 2 * (rng() % (escalated / 2)) + 1;
+      uint8_t how = rng() & 1;
+      push( "refvote", { voter }, [&]( ednadac& c ) { c.refvote( voter, prop_id, how ); } );
+   }
+   advance( cfg.mem_vote_ttl + 60, failures );
+
+   // research cohorts, then members quitting - archiving takes their votes, candidacies and opt-ins with them
+   const uint64_t studies = 4;
+   const uint64_t cohort = std::min<uint64_t>( members / 2, 2000 );
+   const account_name sponsor = N(ednasponsor);
+   mock::add_account( sponsor );
+   push( "transfer", { g_self }, [&]( ednadac& c ) { c.transfer( g_self, sponsor, asset( int64_t(studies * cohort) * 1000, edna ), "" ); } );
+   for( uint64_t r = 0; r < studies; ++r ) {
+      native_bench::add_research( r, members, asset( int64_t(cohort) * 1000, edna ) );
+      for( uint64_t j = 0; j < cohort; ++j ) {
+         account_name member = accounts[ (r * cohort + j) % members ];
+         push( "optin", { member }, [&]( ednadac& c ) { c.optin( member, r ); } );
+      }
+   }
+
+   for( uint64_t i = 0; i < std::min<uint64_t>( members / 100, 1000 ); ++i ) {
+      push( "updatemember", { accounts[i] }, [&]( ednadac& c ) { native_bench::quit( c, accounts[i] ); } );
+   }
+   advance( 60, failures );
+
+   for( uint64_t r = 0; r < studies; ++r ) {
+      native_bench::complete_research( r );
+      push( "fundresearch", { sponsor }, [&]( ednadac& c ) { c.fundresearch( sponsor, r ); } );
+      while( native_bench::research_paid( r ) ) {
+         if( !push( "distribute", { g_self }, [&]( ednadac& c ) { c.distribute( r, 100 ); } ) )
+            break;
+      }
+   }
+}
+
+static void print_report( std::ostream& out ) {
+   char line[256];
+   std::snprintf( line, sizeof(line), "%-14s %9s %6s %10s %9s %9s %9s %10s %8s %10s %8s\n",
+                  "action", "calls", "fails", "total ms", "mean us", "max us", "allocs", "alloc B", "rows", "packed B", "reads" );
+   out << line;
+   for( const auto& r : g_report ) {
+      const auto& s = r.second;
+      double n = s.calls ? double(s.calls) : 1.0;
+      std::snprintf( line, sizeof(line), "%-14s %9llu %6llu %10.1f %9.2f %9.1f %9.1f %10.1f %8.2f %10.1f %8.2f\n",
+                     r.first.c_str(), (unsigned long long)s.calls, (unsigned long long)s.failures,
+                     s.total_ns / 1e6, s.total_ns / 1e3 / n, s.max_ns / 1e3,
+                     s.allocs / n, s.alloc_bytes / n, s.rows_written / n, s.bytes_written / n, s.db_reads / n );
+      out << line;
+   }
+}
+
+static void write_json( std::ostream& out ) {
+   out << "{\"actions\":{";
+   bool first = true;
+   for( const auto& r : g_report ) {
+      const auto& s = r.second;
+      out << (first ? "" : ",") << "\"" << r.first << "\":{\"calls\":" << s.calls << ",\"failures\":" << s.failures
+          << ",\"total_ns\":" << s.total_ns << ",\"max_ns\":" << s.max_ns << ",\"allocs\":" << s.allocs
+          << ",\"alloc_bytes\":" << s.alloc_bytes << ",\"rows_written\":" << s.rows_written
+          << ",\"bytes_written\":" << s.bytes_written << ",\"rows_erased\":" << s.rows_erased
+          << ",\"db_reads\":" << s.db_reads << "}";
+      first = false;
+   }
+   out << "}}\n";
+}
+
+int main( int argc, char** argv ) {
+   const uint64_t members   = arg_value( argc, argv, "--members", 100000 );
+   const uint64_t proposals = arg_value( argc, argv, "--proposals", 10000 );
+   const uint64_t votes     = arg_value( argc, argv, "--votes", 1000000 );
+   std::mt19937_64 rng( arg_value( argc, argv, "--seed", 1 ) );
+
+   if( members == 0 || proposals == 0 ) {
+      std::cerr << "--members and --proposals must be positive\n";
+      return 1;
+   }
+
+   std::ofstream meters_file;
+   if( const char* path = arg_string( argc, argv, "--meters" ) ) {
+#ifdef EDNADAC_METRICS
+      meters_file.open( path );
+      g_meters = &meters_file;
+#else
+      (void)path;
+      std::cerr << "--meters needs a build with EDNADAC_METRICS, ignoring\n";
+#endif
+   }
+
+   mock::set_dispatcher( dispatch );
+   mock::set_time( 1546300800 );                                                // 2019-01-01
+
+   const account_name memfund = N(ednamemfund);
+   const symbol_type  edna = string_to_symbol( 4, "EDNA" );
+   mock::add_account( g_self );
+   mock::add_account( memfund );
+
+   std::vector<account_name> accounts;
+   accounts.reserve( members );
+   for( uint64_t i = 0; i < members; ++i ) {
+      accounts.push_back( member_name( i ) );
+      mock::add_account( accounts.back() );
+   }
+
+   // token and config setup - every member gets enough EDNA for dues and a renewal, the rest funds a reward
+   // and the research payments in governance()
+   push( "create", { g_self }, [&]( ednadac& c ) { c.create( g_self, asset( asset::max_amount, edna ) ); } );
+   push( "issue", { g_self }, [&]( ednadac& c ) { c.issue( g_self, asset( int64_t(members) * 100100 + 8000000, edna ), "" ); } );
+   push( "setmemfund", { g_self }, [&]( ednadac& c ) { c.setmemfund( memfund ); } );
+
+   for( uint64_t i = 0; i < members; i += 100 ) {
+      vector<ednadac::payout> batch;
+      for( uint64_t j = i; j < std::min( members, i + 100 ); ++j )
+         batch.push_back( ednadac::payout{ accounts[j], asset( 100000, edna ) } );
+      push( "transfermany", { g_self }, [&]( ednadac& c ) { c.transfermany( g_self, batch, "", false ); } );
+   }
+
+   for( uint64_t i = 0; i < members; ++i ) {
+      push( "addmember", { accounts[i] }, [&]( ednadac& c ) { c.addmember( accounts[i], "tele", asset( 1, edna ) ); } );
+   }
+
+   for( uint64_t i = 0; i < proposals; ++i ) {
+      account_name sponsor = accounts[ rng() % members ];
+      push( "newgenprop", { sponsor }, [&]( ednadac& c ) { c.newgenprop( sponsor, "proposal", "" ); } );
+   }
+
+   for( uint64_t i = 0; i < votes; ++i ) {
+      account_name voter = accounts[ rng() % members ];
+      uint64_t prop_id = rng() % proposals;
+      uint8_t how = rng() & 1;
+      push( "votegenprop", { voter }, [&]( ednadac& c ) { c.votegenprop( voter, prop_id, how ); } );
+   }
+
+   for( uint64_t i = 0; i < std::min<uint64_t>( members, 1000 ); ++i ) {
+      account_name renewing = accounts[ rng() % members ];
+      push( "renewmember", { renewing }, [&]( ednadac& c ) { c.renewmember( renewing ); } );
+   }
+
+   // fund a reward from the issuer's balance, share it and let some members claim their tokens
+   push( "fundrewards", { g_self }, [&]( ednadac& c ) { c.fundrewards( g_self, asset( int64_t(members) * 100, edna ) ); } );
+   push( "rewardall", { g_self }, [&]( ednadac& c ) { c.rewardall( asset( int64_t(members) * 100, edna ) ); } );
+   for( uint64_t i = 0; i < std::min<uint64_t>( members, 1000 ); ++i ) {
+      account_name claiming = accounts[ rng() % members ];
+      push( "claim", { claiming }, [&]( ednadac& c ) { c.claim( claiming ); } );
+   }
+
+   // let every voting, hold and custodian window run out so globalalarms walks each proposal to its end
+   uint64_t deferred_failures = 0;
+   advance( 60 * 60 * 24 * 30, deferred_failures );
+
+   if( members >= 100 )
+      governance( accounts, rng, votes, deferred_failures );
+
+   print_report( std::cout );
+   if( deferred_failures )
+      std::cout << deferred_failures << " deferred transactions failed\n";
+
+   if( const char* path = arg_string( argc, argv, "--json" ) ) {
+      std::ofstream json( path );
+      write_json( json );
+   }
+   return 0;
+}
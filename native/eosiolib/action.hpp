@@ -0,0 +1,63 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/action.hpp
+ *
+ *  Action data is carried as the argument tuple instead of packed bytes - the harness dispatcher
+ *  unpacks it with std::any_cast. SEND_INLINE_ACTION queues a call that the harness runs, under
+ *  the given authority, after the current action returns.
+ */
+#pragma once
+
+#include <eosiolib/system.hpp>
+
+#include <any>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   struct permission_level {
+      permission_level( account_name a, permission_name p ):actor(a),permission(p){}
+      permission_level(){}
+
+      account_name    actor = 0;
+      permission_name permission = 0;
+   };
+
+   struct action {
+      account_name                  account = 0;
+      action_name                   name = 0;
+      std::vector<permission_level> authorization;
+      std::any                      data;
+
+      action() = default;
+
+      template<typename T>
+      action( const permission_level& auth, account_name a, action_name n, T&& value )
+      :account(a), name(n), authorization(1, auth), data(std::forward<T>(value)) {}
+
+      template<typename T>
+      action( std::vector<permission_level> auths, account_name a, action_name n, T&& value )
+      :account(a), name(n), authorization(std::move(auths)), data(std::forward<T>(value)) {}
+   };
+
+   namespace mock {
+      void send_inline( std::vector<account_name> authorizers, std::function<void()> call );
+   }
+
+   template<typename Contract, typename... Args>
+   void inline_call( Contract& c, void (Contract::*method)(Args...), const permission_level& perm,
+                     std::tuple<typename std::decay<Args>::type...> args ) {
+      account_name receiver = c.get_self();
+      mock::send_inline( { perm.actor }, [receiver, method, args]() {
+         Contract target( receiver );
+         std::apply( [&]( const auto&... a ) { (target.*method)( a... ); }, args );
+      });
+   }
+
+} // namespace eosio
+
+#define SEND_INLINE_ACTION( CONTRACT, NAME, ... ) \
+   ::eosio::inline_call( CONTRACT, &std::remove_reference<decltype(CONTRACT)>::type::NAME, __VA_ARGS__ )
@@ -0,0 +1,25 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/eosio.hpp
+ */
+#pragma once
+
+#include <eosiolib/action.hpp>
+#include <eosiolib/multi_index.hpp>
+#include <eosiolib/print.hpp>
+#include <eosiolib/system.hpp>
+#include <eosiolib/types.hpp>
+
+namespace eosio {
+
+   class contract {
+      public:
+         contract( account_name n ):_self(n){}
+
+         account_name get_self()const { return _self; }
+
+      protected:
+         account_name _self;
+   };
+
+} // namespace eosio
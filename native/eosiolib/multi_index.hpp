@@ -0,0 +1,333 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/multi_index.hpp
+ *
+ *  Each (code, scope, table) owns one table_store shared by every multi_index opened on it, so two
+ *  tables opened in different actions see the same rows - as they would on chain. Rows keep a stable
+ *  address for their lifetime and iterators hold the row, not a position, so an iterator stays valid
+ *  across a modify of its row and steps from the row's current key, matching the chain's behaviour.
+ *  Iterators point into the shared store rather than the multi_index, so they outlive the table object.
+ */
+#pragma once
+
+#include <eosiolib/serialize.hpp>
+#include <eosiolib/system.hpp>
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace eosio {
+
+   template<class Class, typename Type, Type (Class::*PtrToMemberFunction)()const>
+   struct const_mem_fun {
+      typedef typename std::remove_const<typename std::remove_reference<Type>::type>::type result_type;
+
+      result_type operator()( const Class& x )const { return (x.*PtrToMemberFunction)(); }
+   };
+
+   template<uint64_t IndexName, typename Extractor>
+   struct indexed_by {
+      static constexpr uint64_t index_name = IndexName;
+      typedef Extractor secondary_extractor_type;
+   };
+
+   namespace mock {
+      std::shared_ptr<void>& table_slot( uint64_t code, uint64_t scope, uint64_t table );
+      void note_read();
+      void note_write( uint64_t table, size_t bytes );
+      void note_erase( uint64_t table );
+   }
+
+   template<typename T, typename... Indices>
+   struct table_store {
+      typedef std::tuple< std::set< std::pair<typename Indices::secondary_extractor_type::result_type, uint64_t> >... > secondary_sets;
+
+      std::map<uint64_t, std::unique_ptr<T>> rows;
+      secondary_sets                         secondaries;
+   };
+
+   template<uint64_t TableName, typename T, typename... Indices>
+   class multi_index
+   {
+      public:
+         typedef table_store<T, Indices...> store_type;
+
+      private:
+         static constexpr uint64_t index_names[] = { Indices::index_name..., 0 };
+
+         template<uint64_t IndexName>
+         static constexpr size_t index_position() {
+            for( size_t i = 0; i < sizeof...(Indices); ++i )
+               if( index_names[i] == IndexName )
+                  return i;
+            return sizeof...(Indices);
+         }
+
+         template<size_t I>
+         using index_type = typename std::tuple_element<I, std::tuple<Indices...>>::type;
+
+         template<size_t I>
+         static auto secondary_key( const T& obj ) {
+            return typename index_type<I>::secondary_extractor_type()( obj );
+         }
+
+         template<size_t... I>
+         void index_insert( const T& obj, std::index_sequence<I...> ) {
+            (std::get<I>( _store->secondaries ).emplace( secondary_key<I>( obj ), obj.primary_key() ), ...);
+         }
+
+         template<size_t... I>
+         void index_remove( const T& obj, std::index_sequence<I...> ) {
+            (std::get<I>( _store->secondaries ).erase( std::make_pair( secondary_key<I>( obj ), obj.primary_key() ) ), ...);
+         }
+
+         static const T* row( const store_type* store, uint64_t pk ) {
+            auto itr = store->rows.find( pk );
+            return itr == store->rows.end() ? nullptr : itr->second.get();
+         }
+
+         uint64_t    _code;
+         uint64_t    _scope;
+         store_type* _store;
+
+      public:
+         multi_index( uint64_t code, uint64_t scope )
+         :_code(code),_scope(scope) {
+            auto& slot = mock::table_slot( code, scope, TableName );
+            if( !slot )
+               slot = std::make_shared<store_type>();
+            _store = static_cast<store_type*>( slot.get() );
+         }
+
+         uint64_t get_code()const  { return _code; }
+         uint64_t get_scope()const { return _scope; }
+
+         struct const_iterator {
+            const store_type* _store = nullptr;
+            const T*          _item  = nullptr;
+
+            const T& operator*()const  { eosio_assert( _item != nullptr, "cannot dereference end iterator" ); return *_item; }
+            const T* operator->()const { eosio_assert( _item != nullptr, "cannot dereference end iterator" ); return _item; }
+
+            const_iterator& operator++() {
+               eosio_assert( _item != nullptr, "cannot increment end iterator" );
+               auto& rows = _store->rows;
+               auto next = rows.upper_bound( _item->primary_key() );
+               _item = (next == rows.end()) ? nullptr : next->second.get();
+               return *this;
+            }
+
+            const_iterator& operator--() {
+               auto& rows = _store->rows;
+               auto prev = (_item == nullptr) ? rows.end() : rows.lower_bound( _item->primary_key() );
+               eosio_assert( prev != rows.begin(), "cannot decrement iterator at beginning of table" );
+               --prev;
+               _item = prev->second.get();
+               return *this;
+            }
+
+            const_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+            const_iterator operator--(int) { auto tmp = *this; --(*this); return tmp; }
+
+            friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._item == b._item; }
+            friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._item != b._item; }
+         };
+
+         const_iterator make_iterator( const T* item )const { return const_iterator{ _store, item }; }
+
+         const_iterator begin()const {
+            return make_iterator( _store->rows.empty() ? nullptr : _store->rows.begin()->second.get() );
+         }
+         const_iterator end()const { return make_iterator( nullptr ); }
+
+         const_iterator lower_bound( uint64_t primary )const {
+            mock::note_read();
+            auto itr = _store->rows.lower_bound( primary );
+            return make_iterator( itr == _store->rows.end() ? nullptr : itr->second.get() );
+         }
+
+         const_iterator upper_bound( uint64_t primary )const {
+            mock::note_read();
+            auto itr = _store->rows.upper_bound( primary );
+            return make_iterator( itr == _store->rows.end() ? nullptr : itr->second.get() );
+         }
+
+         const_iterator find( uint64_t primary )const {
+            mock::note_read();
+            return make_iterator( row( _store, primary ) );
+         }
+
+         const T& get( uint64_t primary, const char* error_msg = "unable to find key" )const {
+            auto result = find( primary );
+            eosio_assert( result != end(), error_msg );
+            return *result;
+         }
+
+         uint64_t available_primary_key()const {
+            if( _store->rows.empty() )
+               return 0;
+            uint64_t next = _store->rows.rbegin()->first + 1;
+            eosio_assert( next != std::numeric_limits<uint64_t>::max(), "next primary key in table is at autoincrement limit" );
+            return next;
+         }
+
+         template<typename Lambda>
+         const_iterator emplace( uint64_t payer, Lambda&& constructor ) {
+            eosio_assert( payer != 0, "must specify a valid account to pay for new record" );
+
+            std::unique_ptr<T> obj( new T() );
+            constructor( *obj );
+            uint64_t pk = obj->primary_key();
+            eosio_assert( _store->rows.find( pk ) == _store->rows.end(), "could not insert object, most likely a uniqueness constraint was violated" );
+
+            const T* item = obj.get();
+            _store->rows.emplace( pk, std::move(obj) );
+            index_insert( *item, std::index_sequence_for<Indices...>() );
+            mock::note_write( TableName, pack_size( *item ) );
+            return make_iterator( item );
+         }
+
+         template<typename Lambda>
+         void modify( const_iterator itr, uint64_t payer, Lambda&& updater ) {
+            eosio_assert( itr != end(), "cannot pass end iterator to modify" );
+            modify( *itr, payer, std::forward<Lambda>(updater) );
+         }
+
+         template<typename Lambda>
+         void modify( const T& obj, uint64_t, Lambda&& updater ) {
+            T& mutable_item = const_cast<T&>( obj );
+            uint64_t pk = obj.primary_key();
+
+            index_remove( obj, std::index_sequence_for<Indices...>() );
+            updater( mutable_item );
+            eosio_assert( pk == obj.primary_key(), "updater cannot change primary key when modifying an object" );
+            index_insert( obj, std::index_sequence_for<Indices...>() );
+            mock::note_write( TableName, pack_size( obj ) );
+         }
+
+         const_iterator erase( const_iterator itr ) {
+            eosio_assert( itr != end(), "cannot pass end iterator to erase" );
+            const_iterator next = itr;
+            ++next;
+            erase( *itr );
+            return next;
+         }
+
+         void erase( const T& obj ) {
+            uint64_t pk = obj.primary_key();
+            index_remove( obj, std::index_sequence_for<Indices...>() );
+            _store->rows.erase( pk );
+            mock::note_erase( TableName );
+         }
+
+         template<size_t I>
+         class index {
+            public:
+               typedef typename index_type<I>::secondary_extractor_type::result_type secondary_key_type;
+
+            private:
+               typedef std::set< std::pair<secondary_key_type, uint64_t> > set_type;
+
+               multi_index* _multidx;
+
+               static const set_type& entries( const store_type* store ) { return std::get<I>( store->secondaries ); }
+               const set_type& entries()const { return entries( _multidx->_store ); }
+
+            public:
+               explicit index( multi_index* midx ):_multidx(midx) {}
+
+               struct const_iterator {
+                  const store_type* _store = nullptr;
+                  const T*          _item  = nullptr;
+
+                  const T& operator*()const  { eosio_assert( _item != nullptr, "cannot dereference end iterator" ); return *_item; }
+                  const T* operator->()const { eosio_assert( _item != nullptr, "cannot dereference end iterator" ); return _item; }
+
+                  const_iterator& operator++() {
+                     eosio_assert( _item != nullptr, "cannot increment end iterator" );
+                     auto& set = entries( _store );
+                     auto next = set.upper_bound( std::make_pair( secondary_key<I>( *_item ), _item->primary_key() ) );
+                     _item = (next == set.end()) ? nullptr : row( _store, next->second );
+                     return *this;
+                  }
+
+                  const_iterator& operator--() {
+                     auto& set = entries( _store );
+                     auto prev = (_item == nullptr) ? set.end()
+                                                    : set.lower_bound( std::make_pair( secondary_key<I>( *_item ), _item->primary_key() ) );
+                     eosio_assert( prev != set.begin(), "cannot decrement iterator at beginning of index" );
+                     --prev;
+                     _item = row( _store, prev->second );
+                     return *this;
+                  }
+
+                  const_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+                  const_iterator operator--(int) { auto tmp = *this; --(*this); return tmp; }
+
+                  friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._item == b._item; }
+                  friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._item != b._item; }
+               };
+
+               const_iterator make_iterator( typename set_type::const_iterator itr )const {
+                  return const_iterator{ _multidx->_store, itr == entries().end() ? nullptr : row( _multidx->_store, itr->second ) };
+               }
+
+               const_iterator begin()const { return make_iterator( entries().begin() ); }
+               const_iterator end()const   { return const_iterator{ _multidx->_store, nullptr }; }
+
+               const_iterator lower_bound( const secondary_key_type& secondary )const {
+                  mock::note_read();
+                  return make_iterator( entries().lower_bound( std::make_pair( secondary, uint64_t(0) ) ) );
+               }
+
+               const_iterator upper_bound( const secondary_key_type& secondary )const {
+                  mock::note_read();
+                  return make_iterator( entries().upper_bound( std::make_pair( secondary, std::numeric_limits<uint64_t>::max() ) ) );
+               }
+
+               const_iterator find( const secondary_key_type& secondary )const {
+                  auto itr = lower_bound( secondary );
+                  if( itr == end() || secondary_key<I>( *itr ) != secondary )
+                     return end();
+                  return itr;
+               }
+
+               const T& get( const secondary_key_type& secondary, const char* error_msg = "unable to find secondary key" )const {
+                  auto result = find( secondary );
+                  eosio_assert( result != end(), error_msg );
+                  return *result;
+               }
+
+               template<typename Lambda>
+               void modify( const_iterator itr, uint64_t payer, Lambda&& updater ) {
+                  eosio_assert( itr != end(), "cannot pass end iterator to modify" );
+                  _multidx->modify( *itr, payer, std::forward<Lambda>(updater) );
+               }
+
+               const_iterator erase( const_iterator itr ) {
+                  eosio_assert( itr != end(), "cannot pass end iterator to erase" );
+                  const_iterator next = itr;
+                  ++next;
+                  _multidx->erase( *itr );
+                  return next;
+               }
+         };
+
+         template<uint64_t IndexName>
+         auto get_index() {
+            constexpr size_t pos = index_position<IndexName>();
+            static_assert( pos < sizeof...(Indices), "name provided is not the name of any secondary index within multi_index" );
+            return index<pos>( this );
+         }
+
+         template<uint64_t IndexName>
+         auto get_index()const {
+            return const_cast<multi_index*>( this )->template get_index<IndexName>();
+         }
+   };
+
+} // namespace eosio
@@ -0,0 +1,35 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/print.hpp - output goes to the harness console stream
+ */
+#pragma once
+
+#include <eosiolib/types.hpp>
+
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace eosio {
+
+   namespace mock {
+      std::ostream& console();
+   }
+
+   inline void print_one( const char* s )        { mock::console() << s; }
+   inline void print_one( const std::string& s ) { mock::console() << s; }
+
+   template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+   void print_one( T v ) {
+      if( std::is_signed<T>::value )
+         mock::console() << static_cast<long long>(v);
+      else
+         mock::console() << static_cast<unsigned long long>(v);
+   }
+
+   template<typename... Args>
+   void print( Args&&... args ) {
+      (print_one( args ), ...);
+   }
+
+} // namespace eosio
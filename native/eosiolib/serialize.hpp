@@ -0,0 +1,79 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/serialize.hpp
+ *
+ *  Rows are kept as C++ objects, so the only stream needed is one that measures the packed size -
+ *  it follows the chain's encoding (fixed width integers, varint length prefixes) so the byte counts match
+ */
+#pragma once
+
+#include <eosiolib/types.hpp>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   struct size_stream {
+      size_t pos = 0;
+
+      void   skip( size_t n ) { pos += n; }
+      size_t tellp()const     { return pos; }
+   };
+
+   inline size_stream& pack_varint( size_stream& ds, uint64_t v ) {
+      do {
+         ds.skip(1);
+         v >>= 7;
+      } while( v );
+      return ds;
+   }
+
+   template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+   size_stream& operator<<( size_stream& ds, const T& ) {
+      ds.skip( sizeof(T) );
+      return ds;
+   }
+
+   inline size_stream& operator<<( size_stream& ds, const uint128_t& ) { ds.skip(16); return ds; }
+   inline size_stream& operator<<( size_stream& ds, const int128_t& )  { ds.skip(16); return ds; }
+   inline size_stream& operator<<( size_stream& ds, const checksum256& ) { ds.skip(32); return ds; }
+
+   inline size_stream& operator<<( size_stream& ds, const std::string& s ) {
+      pack_varint( ds, s.size() );
+      ds.skip( s.size() );
+      return ds;
+   }
+
+   template<typename T>
+   size_stream& operator<<( size_stream& ds, const std::vector<T>& v ) {
+      pack_varint( ds, v.size() );
+      for( const auto& i : v )
+         ds << i;
+      return ds;
+   }
+
+   template<typename T>
+   size_t pack_size( const T& value ) {
+      size_stream ps;
+      ps << value;
+      return ps.tellp();
+   }
+
+} // namespace eosio
+
+// EOSLIB_SERIALIZE( TYPE, (a)(b)(c) ) - walks the member sequence with two alternating macros instead of boost.pp
+#define EOSLIB_SERIALIZE_FIELD_A(x) ds << t.x; EOSLIB_SERIALIZE_FIELD_B
+#define EOSLIB_SERIALIZE_FIELD_B(x) ds << t.x; EOSLIB_SERIALIZE_FIELD_A
+#define EOSLIB_SERIALIZE_FIELD_A_END
+#define EOSLIB_SERIALIZE_FIELD_B_END
+#define EOSLIB_SERIALIZE_CAT(a, b) EOSLIB_SERIALIZE_CAT_I(a, b)
+#define EOSLIB_SERIALIZE_CAT_I(a, b) a ## b
+
+#define EOSLIB_SERIALIZE( TYPE, MEMBERS ) \
+   template<typename DataStream> \
+   friend DataStream& operator<<( DataStream& ds, const TYPE& t ) { \
+      EOSLIB_SERIALIZE_CAT( EOSLIB_SERIALIZE_FIELD_A MEMBERS, _END ) \
+      return ds; \
+   }
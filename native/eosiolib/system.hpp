@@ -0,0 +1,17 @@
+/**
+ *  @file
+ *  host-side stand-in for the eosiolib C intrinsics - see mock.cpp
+ */
+#pragma once
+
+#include <eosiolib/types.hpp>
+
+void     eosio_assert( uint32_t test, const char* msg );
+uint32_t now();
+
+void     require_auth( account_name name );
+bool     has_auth( account_name name );
+void     require_recipient( account_name name );
+bool     is_account( account_name name );
+
+int      cancel_deferred( const uint128_t& sender_id );
@@ -0,0 +1,30 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/transaction.hpp - deferred transactions wait in the harness
+ *  until the mock clock reaches their delay
+ */
+#pragma once
+
+#include <eosiolib/action.hpp>
+
+#include <vector>
+
+namespace eosio {
+
+   class transaction;
+
+   namespace mock {
+      void send_deferred( const uint128_t& sender_id, account_name payer, const transaction& trx, bool replace_existing );
+   }
+
+   class transaction {
+      public:
+         std::vector<action> actions;
+         uint32_t            delay_sec = 0;
+
+         void send( const uint128_t& sender_id, account_name payer, bool replace_existing = false )const {
+            mock::send_deferred( sender_id, payer, *this, replace_existing );
+         }
+   };
+
+} // namespace eosio
@@ -0,0 +1,58 @@
+/**
+ *  @file
+ *  host-side stand-in for eosiolib/types.hpp - only what ednadac uses
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+typedef uint64_t account_name;
+typedef uint64_t permission_name;
+typedef uint64_t action_name;
+typedef uint64_t table_name;
+typedef uint64_t scope_name;
+typedef uint64_t symbol_name;
+
+typedef unsigned __int128 uint128_t;
+typedef __int128 int128_t;
+
+struct checksum256 {
+   uint8_t hash[32];
+};
+
+namespace eosio {
+
+   static constexpr char char_to_symbol( char c ) {
+      if( c >= 'a' && c <= 'z' )
+         return (c - 'a') + 6;
+      if( c >= '1' && c <= '5' )
+         return (c - '1') + 1;
+      return 0;
+   }
+
+   // same 5 bit packing as the chain, so names sort and print the way they do on a node
+   static constexpr uint64_t string_to_name( const char* str ) {
+      uint32_t len = 0;
+      while( str[len] ) ++len;
+
+      uint64_t value = 0;
+      for( uint32_t i = 0; i <= 12; ++i ) {
+         uint64_t c = 0;
+         if( i < len && i <= 12 ) c = uint64_t(char_to_symbol( str[i] ));
+
+         if( i < 12 ) {
+            c &= 0x1f;
+            c <<= 64-5*(i+1);
+         }
+         else {
+            c &= 0x0f;
+         }
+         value |= c;
+      }
+      return value;
+   }
+
+#define N(X) ::eosio::string_to_name(#X)
+
+} // namespace eosio
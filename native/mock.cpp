@@ -0,0 +1,215 @@
+/**
+ *  @file
+ *  in-memory implementation of the eosiolib intrinsics used by ednadac
+ */
+
+#include "mock.hpp"
+
+#include <eosiolib/eosio.hpp>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace eosio { namespace mock {
+
+   namespace {
+
+      struct pending_trx {
+         uint32_t    due;
+         uint64_t    seq;
+         transaction trx;
+      };
+
+      struct null_buffer : std::streambuf {
+         int overflow( int c ) override { return c; }
+      };
+
+      struct chain {
+         uint32_t                                                           clock = 0;
+         std::vector<account_name>                                          auths;
+         std::set<account_name>                                             accounts;
+         std::map<std::tuple<uint64_t, uint64_t, uint64_t>, std::shared_ptr<void>> tables;
+         std::map<std::pair<account_name, uint128_t>, pending_trx>          deferred;
+         uint64_t                                                           deferred_seq = 0;
+         std::deque<std::pair<std::vector<account_name>, std::function<void()>>> inline_queue;
+         std::function<void(const action&)>                                 dispatch;
+         counters                                                           stats;
+         null_buffer                                                        discard_buf;
+         std::ostream                                                       discard{ &discard_buf };
+         std::ostream*                                                      console = nullptr;
+      };
+
+      chain& state() {
+         static chain c;
+         return c;
+      }
+
+      const char* name_charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+
+   }
+
+   counters& stats() { return state().stats; }
+
+   void     set_time( uint32_t seconds ) { state().clock = seconds; }
+   uint32_t get_time()                   { return state().clock; }
+
+   void set_auth( std::vector<account_name> authorizers ) { state().auths = std::move(authorizers); }
+   void add_account( account_name name )                  { state().accounts.insert( name ); }
+
+   void set_console( std::ostream* out ) { state().console = out; }
+
+   std::ostream& console() {
+      auto& c = state();
+      return c.console ? *c.console : c.discard;
+   }
+
+   void set_dispatcher( std::function<void(const action&)> dispatch ) { state().dispatch = std::move(dispatch); }
+
+   std::shared_ptr<void>& table_slot( uint64_t code, uint64_t scope, uint64_t table ) {
+      return state().tables[ std::make_tuple( code, scope, table ) ];
+   }
+
+   void note_read() { state().stats.db_reads++; }
+
+   void note_write( uint64_t, size_t bytes ) {
+      state().stats.rows_written++;
+      state().stats.bytes_written += bytes;
+   }
+
+   void note_erase( uint64_t ) { state().stats.rows_erased++; }
+
+   void send_inline( std::vector<account_name> authorizers, std::function<void()> call ) {
+      state().inline_queue.emplace_back( std::move(authorizers), std::move(call) );
+   }
+
+   void send_deferred( const uint128_t& sender_id, account_name payer, const transaction& trx, bool replace_existing ) {
+      auto& c = state();
+      auto key = std::make_pair( payer, sender_id );
+      eosio_assert( replace_existing || c.deferred.find( key ) == c.deferred.end(), "deferred transaction with the same sender_id and payer already exists" );
+      c.deferred[key] = pending_trx{ c.clock + trx.delay_sec, c.deferred_seq++, trx };
+   }
+
+   size_t run_inline() {
+      auto& c = state();
+      size_t ran = 0;
+      while( !c.inline_queue.empty() ) {
+         auto next = std::move( c.inline_queue.front() );
+         c.inline_queue.pop_front();
+         c.auths = std::move( next.first );
+         next.second();
+         ran++;
+      }
+      return ran;
+   }
+
+   bool next_deferred( uint32_t& due ) {
+      auto& c = state();
+      if( c.deferred.empty() )
+         return false;
+      due = c.deferred.begin()->second.due;
+      for( const auto& d : c.deferred )
+         due = std::min( due, d.second.due );
+      return true;
+   }
+
+   size_t run_deferred( uint64_t& failures ) {
+      auto& c = state();
+      size_t ran = 0;
+      for( ;; ) {
+         auto found = c.deferred.end();
+         for( auto itr = c.deferred.begin(); itr != c.deferred.end(); ++itr ) {
+            if( itr->second.due > c.clock )
+               continue;
+            if( found == c.deferred.end() || itr->second.due < found->second.due
+                || (itr->second.due == found->second.due && itr->second.seq < found->second.seq) )
+               found = itr;
+         }
+         if( found == c.deferred.end() )
+            return ran;
+
+         transaction trx = std::move( found->second.trx );
+         c.deferred.erase( found );                                              // the action may queue itself again
+         try {
+            for( const auto& act : trx.actions ) {
+               std::vector<account_name> actors;
+               for( const auto& p : act.authorization )
+                  actors.push_back( p.actor );
+               c.auths = actors;
+               c.dispatch( act );
+               run_inline();
+            }
+         } catch( const assert_error& ) {
+            c.inline_queue.clear();
+            failures++;
+         }
+         ran++;
+      }
+   }
+
+   uint64_t name_from_string( const std::string& s ) {
+      uint64_t value = 0;
+      for( size_t i = 0; i <= 12; ++i ) {
+         uint64_t ch = (i < s.size()) ? uint64_t( char_to_symbol( s[i] ) ) : 0;
+         if( i < 12 ) {
+            ch &= 0x1f;
+            ch <<= 64 - 5 * (i + 1);
+         }
+         else {
+            ch &= 0x0f;
+         }
+         value |= ch;
+      }
+      return value;
+   }
+
+   std::string name_to_string( uint64_t value ) {
+      std::string str( 13, '.' );
+      uint64_t tmp = value;
+      for( uint32_t i = 0; i <= 12; ++i ) {
+         char ch = name_charmap[ tmp & (i == 0 ? 0x0f : 0x1f) ];
+         str[12 - i] = ch;
+         tmp >>= (i == 0 ? 4 : 5);
+      }
+      auto last = str.find_last_not_of( '.' );
+      return last == std::string::npos ? std::string() : str.substr( 0, last + 1 );
+   }
+
+} } // namespace eosio::mock
+
+using namespace eosio;
+
+void eosio_assert( uint32_t test, const char* msg ) {
+   if( !test )
+      throw mock::assert_error( msg );
+}
+
+uint32_t now() { return mock::get_time(); }
+
+bool has_auth( account_name name ) {
+   for( auto a : mock::state().auths )
+      if( a == name )
+         return true;
+   return false;
+}
+
+void require_auth( account_name name ) {
+   if( !has_auth( name ) )
+      throw mock::assert_error( "missing authority of " + mock::name_to_string( name ) );
+}
+
+void require_recipient( account_name ) {}
+
+bool is_account( account_name name ) { return mock::state().accounts.count( name ) > 0; }
+
+int cancel_deferred( const uint128_t& sender_id ) {
+   auto& deferred = mock::state().deferred;
+   for( auto itr = deferred.begin(); itr != deferred.end(); ++itr ) {
+      if( itr->first.second == sender_id ) {
+         deferred.erase( itr );
+         return 1;
+      }
+   }
+   return 0;
+}
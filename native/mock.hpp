@@ -0,0 +1,52 @@
+/**
+ *  @file
+ *  harness side of the in-memory eosiolib - clock, authority, accounts, the deferred and inline
+ *  queues and the per-action counters the benchmark reports
+ *
+ *  Failed actions are not rolled back: an eosio_assert throws mock::assert_error and whatever the
+ *  action wrote before it stays written, so workloads should only replay actions expected to pass
+ */
+#pragma once
+
+#include <eosiolib/transaction.hpp>
+
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace eosio { namespace mock {
+
+   struct assert_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   struct counters {
+      uint64_t db_reads = 0;                                                     // find / lower_bound / upper_bound calls
+      uint64_t rows_written = 0;                                                 // emplaces and modifies
+      uint64_t rows_erased = 0;
+      uint64_t bytes_written = 0;                                                // packed size of every row written
+   };
+
+   counters& stats();
+
+   void     set_time( uint32_t seconds );
+   uint32_t get_time();
+
+   void     set_auth( std::vector<account_name> authorizers );
+   void     add_account( account_name name );
+
+   void     set_console( std::ostream* out );                                    // nullptr discards print()
+
+   // runs a queued deferred or inline action - the harness owns the contract, so it owns dispatch too
+   void     set_dispatcher( std::function<void(const action&)> dispatch );
+
+   size_t   run_inline();                                                        // drains the inline queue, returns actions run
+   size_t   run_deferred( uint64_t& failures );                                  // runs everything due at the current time
+   bool     next_deferred( uint32_t& due );                                      // earliest pending deferred transaction
+
+   uint64_t    name_from_string( const std::string& s );
+   std::string name_to_string( uint64_t value );
+
+} } // namespace eosio::mock